@@ -19,5 +19,13 @@ const float EnemySpeed = 150.0f;
 const int EnemyDamage = 10;
 const int EnemyHealth = 25;
 const int EnemySpawnCount = 2;
+const float SpawnRetryInterval = 0.5f; // Wait before retrying a wave the spawn budget refused
 
-const float BasePushForce = 7.5f;
\ No newline at end of file
+const float CollisionCellSize = 64.0f;
+const float CollisionWorldMargin = 50.0f; // Projectiles live this far off-screen
+
+const float BasePushForce = 7.5f;
+const float StreamEmitterRate = 60.0f; // Sand/water cells per second
+const float WoodBlobDensity = 0.85f; // Fraction of cells filled inside a wood blob
+
+const float FrameBudgetMs = 16.6f; // CPU time per frame the quality governor aims for
\ No newline at end of file
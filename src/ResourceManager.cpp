@@ -1,6 +1,38 @@
 #include "ResourceManager.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
 #include <algorithm>
-#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+
+namespace
+{
+    bool isReady(const std::shared_future<bool>& future)
+    {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    std::shared_future<bool> makeReadyFuture(bool value)
+    {
+        std::promise<bool> done;
+        done.set_value(value);
+        return done.get_future().share();
+    }
+
+    // Loads run on the shared job pool; nothing waits on this counter per frame,
+    // only shutdown() does
+    JobCounter s_loadJobs;
+
+    template<typename Load>
+    std::shared_future<bool> loadOnJobPool(Load load)
+    {
+        auto pDone = std::make_shared<std::promise<bool>>();
+        std::shared_future<bool> ready = pDone->get_future().share();
+        JobSystem::submitTask([pDone, load]() { pDone->set_value(load()); }, &s_loadJobs);
+        return ready;
+    }
+}
 
 void ResourceManager::init(std::string executablePath)
 {
@@ -9,19 +41,41 @@ void ResourceManager::init(std::string executablePath)
     if (lastSlashIndex != std::string::npos)
         m_assetPath = executablePath.substr(0, lastSlashIndex + 1);
     m_assetPath += + "assets/";
+
+    if (m_archive.open("assets.pak"))
+        LOG_INFO("Mapped asset archive with {} entries", m_archive.getEntryCount());
+    else
+        LOG_INFO("No asset archive, loading loose files");
 }
 
 const sf::Font* ResourceManager::getOrLoadFont(const std::string& filename)
 {
-    auto it = m_loadedFonts.find(filename);
-    if (it != m_loadedFonts.end())
-        return &it->second;
+    PendingAsset<std::vector<char>> pending;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        auto it = m_loadedFonts.find(filename);
+        if (it != m_loadedFonts.end())
+            return &it->second;
+
+        auto pendingIt = m_pendingFonts.find(filename);
+        if (pendingIt != m_pendingFonts.end())
+            pending = pendingIt->second;
+    }
+    if (pending.pPayload)
+        return finishFont(filename, pending);
 
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
     auto res = m_loadedFonts.emplace(filename, sf::Font());
     if (!res.second)
         return nullptr;
     
     sf::Font* pFont = &res.first->second;
+    if (const AssetArchiveEntry* pEntry = m_archive.find(filename))
+    {
+        if (!pFont->openFromMemory(m_archive.getData(*pEntry), pEntry->size))
+            return nullptr;
+        return pFont;
+    }
     if (!pFont->openFromFile(getAssetPath(filename)))
         return nullptr;
     return pFont; 
@@ -29,15 +83,32 @@ const sf::Font* ResourceManager::getOrLoadFont(const std::string& filename)
 
 const sf::Texture* ResourceManager::getOrLoadTexture(const std::string& filename)
 {
-    auto it = m_loadedTextures.find(filename);
-    if (it != m_loadedTextures.end())
-        return &it->second;
+    PendingAsset<sf::Image> pending;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        auto it = m_loadedTextures.find(filename);
+        if (it != m_loadedTextures.end())
+            return &it->second;
 
+        auto pendingIt = m_pendingTextures.find(filename);
+        if (pendingIt != m_pendingTextures.end())
+            pending = pendingIt->second;
+    }
+    if (pending.pPayload)
+        return finishTexture(filename, pending);
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
     auto res = m_loadedTextures.emplace(filename, sf::Texture());
     if (!res.second)
         return nullptr;
 
     sf::Texture* pTexture = &res.first->second;
+    if (const AssetArchiveEntry* pEntry = m_archive.find(filename))
+    {
+        if (!loadTextureFromArchive(*pTexture, *pEntry))
+            return nullptr;
+        return pTexture;
+    }
     if (!pTexture->loadFromFile(getAssetPath(filename)))
         return nullptr;
     return pTexture;
@@ -45,25 +116,308 @@ const sf::Texture* ResourceManager::getOrLoadTexture(const std::string& filename
 
 const sf::SoundBuffer* ResourceManager::getOrLoadSoundBuffer(const std::string& filename)
 {
-    auto it = m_loadedSoundBuffers.find(filename);
-    if (it != m_loadedSoundBuffers.end())
-        return &it->second;
+    PendingAsset<sf::SoundBuffer> pending;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        auto it = m_loadedSoundBuffers.find(filename);
+        if (it != m_loadedSoundBuffers.end())
+            return &it->second;
+
+        auto pendingIt = m_pendingSoundBuffers.find(filename);
+        if (pendingIt != m_pendingSoundBuffers.end())
+            pending = pendingIt->second;
+    }
+    if (pending.pPayload)
+        return finishSoundBuffer(filename, pending);
 
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
     auto res = m_loadedSoundBuffers.emplace(filename, sf::SoundBuffer());
     if (!res.second)
         return nullptr;
 
     sf::SoundBuffer* pSoundBuffer = &res.first->second;
+    if (const AssetArchiveEntry* pEntry = m_archive.find(filename))
+    {
+        if (!pSoundBuffer->loadFromMemory(m_archive.getData(*pEntry), pEntry->size))
+            return nullptr;
+        return pSoundBuffer;
+    }
     if (!pSoundBuffer->loadFromFile(getAssetPath(filename)))
         return nullptr;
     return pSoundBuffer;
 }
 
+std::shared_future<bool> ResourceManager::requestFont(const std::string& filename)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto pendingIt = m_pendingFonts.find(filename);
+    if (pendingIt != m_pendingFonts.end())
+        return pendingIt->second.ready;
+    if (m_loadedFonts.count(filename))
+        return makeReadyFuture(true);
+
+    // Fonts are opened from memory, so the worker only has to read the file.
+    // A font in the archive is already in memory and needs no worker at all.
+    auto pData = std::make_shared<std::vector<char>>();
+    if (m_archive.find(filename))
+    {
+        std::shared_future<bool> ready = makeReadyFuture(true);
+        m_pendingFonts[filename] = {ready, pData};
+        return ready;
+    }
+
+    std::filesystem::path path = getAssetPath(filename);
+    std::shared_future<bool> ready = loadOnJobPool([pData, path]()
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        pData->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !pData->empty();
+    });
+
+    m_pendingFonts[filename] = {ready, pData};
+    return ready;
+}
+
+std::shared_future<bool> ResourceManager::requestTexture(const std::string& filename)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto pendingIt = m_pendingTextures.find(filename);
+    if (pendingIt != m_pendingTextures.end())
+        return pendingIt->second.ready;
+    if (m_loadedTextures.count(filename))
+        return makeReadyFuture(true);
+
+    auto pImage = std::make_shared<sf::Image>();
+    if (const AssetArchiveEntry* pEntry = m_archive.find(filename))
+    {
+        // Pre-decoded RGBA is uploaded straight from the mapping in finishTexture
+        std::shared_future<bool> ready;
+        if (pEntry->encoding == ASSET_ENCODING_RGBA8)
+            ready = makeReadyFuture(true);
+        else
+        {
+            const void* pSource = m_archive.getData(*pEntry);
+            size_t size = pEntry->size;
+            ready = loadOnJobPool([pImage, pSource, size]()
+            {
+                return pImage->loadFromMemory(pSource, size);
+            });
+        }
+        m_pendingTextures[filename] = {ready, pImage};
+        return ready;
+    }
+
+    std::filesystem::path path = getAssetPath(filename);
+    std::shared_future<bool> ready = loadOnJobPool([pImage, path]()
+    {
+        return pImage->loadFromFile(path);
+    });
+
+    m_pendingTextures[filename] = {ready, pImage};
+    return ready;
+}
+
+std::shared_future<bool> ResourceManager::requestSoundBuffer(const std::string& filename)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto pendingIt = m_pendingSoundBuffers.find(filename);
+    if (pendingIt != m_pendingSoundBuffers.end())
+        return pendingIt->second.ready;
+    if (m_loadedSoundBuffers.count(filename))
+        return makeReadyFuture(true);
+
+    auto pSoundBuffer = std::make_shared<sf::SoundBuffer>();
+    if (const AssetArchiveEntry* pEntry = m_archive.find(filename))
+    {
+        const void* pSource = m_archive.getData(*pEntry);
+        size_t size = pEntry->size;
+        std::shared_future<bool> ready = loadOnJobPool([pSoundBuffer, pSource, size]()
+        {
+            return pSoundBuffer->loadFromMemory(pSource, size);
+        });
+        m_pendingSoundBuffers[filename] = {ready, pSoundBuffer};
+        return ready;
+    }
+
+    std::filesystem::path path = getAssetPath(filename);
+    std::shared_future<bool> ready = loadOnJobPool([pSoundBuffer, path]()
+    {
+        return pSoundBuffer->loadFromFile(path);
+    });
+
+    m_pendingSoundBuffers[filename] = {ready, pSoundBuffer};
+    return ready;
+}
+
+void ResourceManager::preload(const AssetManifestEntry* manifest, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (manifest[i].type)
+        {
+            case ASSET_TYPE_TEXTURE:
+                requestTexture(manifest[i].filename);
+                break;
+            case ASSET_TYPE_FONT:
+                requestFont(manifest[i].filename);
+                break;
+            case ASSET_TYPE_SOUND:
+                requestSoundBuffer(manifest[i].filename);
+                break;
+        }
+    }
+}
+
+const sf::Font* ResourceManager::finishFont(const std::string& filename, const PendingAsset<std::vector<char>>& pending)
+{
+    bool ok = pending.ready.get();
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_pendingFonts.erase(filename);
+    if (!ok)
+        return nullptr;
+
+    auto res = m_loadedFonts.emplace(filename, sf::Font());
+    sf::Font* pFont = &res.first->second;
+    if (!res.second)
+        return pFont;
+
+    if (const AssetArchiveEntry* pEntry = m_archive.find(filename))
+    {
+        if (!pFont->openFromMemory(m_archive.getData(*pEntry), pEntry->size))
+        {
+            m_loadedFonts.erase(res.first);
+            return nullptr;
+        }
+        return pFont;
+    }
+
+    // The font reads glyphs from this buffer for as long as it lives
+    auto pData = std::make_unique<std::vector<char>>(*pending.pPayload);
+    if (!pFont->openFromMemory(pData->data(), pData->size()))
+    {
+        m_loadedFonts.erase(res.first);
+        return nullptr;
+    }
+    m_fontData[filename] = std::move(pData);
+    return pFont;
+}
+
+const sf::Texture* ResourceManager::finishTexture(const std::string& filename, const PendingAsset<sf::Image>& pending)
+{
+    bool ok = pending.ready.get();
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_pendingTextures.erase(filename);
+    if (!ok)
+        return nullptr;
+
+    auto res = m_loadedTextures.emplace(filename, sf::Texture());
+    sf::Texture* pTexture = &res.first->second;
+    if (!res.second)
+        return pTexture;
+
+    const AssetArchiveEntry* pEntry = m_archive.find(filename);
+    bool uploaded = pEntry && pEntry->encoding == ASSET_ENCODING_RGBA8
+        ? loadTextureFromArchive(*pTexture, *pEntry)
+        : pTexture->loadFromImage(*pending.pPayload);
+    if (!uploaded)
+    {
+        m_loadedTextures.erase(res.first);
+        return nullptr;
+    }
+    return pTexture;
+}
+
+const sf::SoundBuffer* ResourceManager::finishSoundBuffer(const std::string& filename, const PendingAsset<sf::SoundBuffer>& pending)
+{
+    bool ok = pending.ready.get();
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_pendingSoundBuffers.erase(filename);
+    if (!ok)
+        return nullptr;
+
+    auto res = m_loadedSoundBuffers.emplace(filename, *pending.pPayload);
+    return &res.first->second;
+}
+
+void ResourceManager::update(int maxUploads)
+{
+    // Collect finished work under the lock, then finish it outside so a slow
+    // upload never holds up a worker that wants to register more work
+    std::vector<std::pair<std::string, PendingAsset<sf::Image>>> textures;
+    std::vector<std::pair<std::string, PendingAsset<std::vector<char>>>> fonts;
+    std::vector<std::pair<std::string, PendingAsset<sf::SoundBuffer>>> sounds;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        if (m_pendingTextures.empty() && m_pendingFonts.empty() && m_pendingSoundBuffers.empty())
+            return;
+
+        for (const auto& [filename, pending] : m_pendingTextures)
+        {
+            if (static_cast<int>(textures.size()) < maxUploads && isReady(pending.ready))
+                textures.emplace_back(filename, pending);
+        }
+        for (const auto& [filename, pending] : m_pendingFonts)
+        {
+            if (isReady(pending.ready))
+                fonts.emplace_back(filename, pending);
+        }
+        for (const auto& [filename, pending] : m_pendingSoundBuffers)
+        {
+            if (isReady(pending.ready))
+                sounds.emplace_back(filename, pending);
+        }
+    }
+
+    for (const auto& [filename, pending] : textures)
+        finishTexture(filename, pending);
+    for (const auto& [filename, pending] : fonts)
+        finishFont(filename, pending);
+    for (const auto& [filename, pending] : sounds)
+        finishSoundBuffer(filename, pending);
+}
+
+bool ResourceManager::isIdle()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_pendingTextures.empty() && m_pendingFonts.empty() && m_pendingSoundBuffers.empty();
+}
+
+void ResourceManager::shutdown()
+{
+    // Let in-flight loads finish before the payloads they write into go away
+    JobSystem::wait(s_loadJobs);
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    for (auto& [filename, pending] : m_pendingTextures)
+        pending.ready.wait();
+    for (auto& [filename, pending] : m_pendingFonts)
+        pending.ready.wait();
+    for (auto& [filename, pending] : m_pendingSoundBuffers)
+        pending.ready.wait();
+    m_pendingTextures.clear();
+    m_pendingFonts.clear();
+    m_pendingSoundBuffers.clear();
+}
+
+bool ResourceManager::loadTextureFromArchive(sf::Texture& texture, const AssetArchiveEntry& entry)
+{
+    if (entry.encoding == ASSET_ENCODING_RGBA8)
+    {
+        if (!texture.resize({entry.width, entry.height}))
+            return false;
+        texture.update(static_cast<const uint8_t*>(m_archive.getData(entry)));
+        return true;
+    }
+    return texture.loadFromMemory(m_archive.getData(entry), entry.size);
+}
+
 std::filesystem::path ResourceManager::getAssetPath(const std::string& filename)
 {
     std::filesystem::path path = "assets/" + filename;
 
     return path;
 }
-
-
@@ -3,23 +3,77 @@
 #include <string>
 #include <unordered_map>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "core/AssetArchive.h"
 #include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 
+enum AssetType
+{
+    ASSET_TYPE_TEXTURE = 0,
+    ASSET_TYPE_FONT = 1,
+    ASSET_TYPE_SOUND = 2
+};
+
+struct AssetManifestEntry
+{
+    AssetType type;
+    const char* filename;
+};
+
 class ResourceManager
 {
 public:
+    // Maps assets.pak if the build produced one; every asset found in it is
+    // loaded from the mapping, anything else from the loose files
     static void init(std::string executablePath);
     static const sf::Font* getOrLoadFont(const std::string& filename);
     static const sf::Texture* getOrLoadTexture(const std::string& filename);
     static const sf::SoundBuffer* getOrLoadSoundBuffer(const std::string& filename);
 
+    // Asynchronous loading. Files are read and decoded on the job pool and the
+    // futures resolve once decoding is done; update() then finishes the assets on
+    // the main thread, which for textures means only the GPU upload. getOrLoad*
+    // on an asset still in flight waits for it instead of loading it twice.
+    static std::shared_future<bool> requestTexture(const std::string& filename);
+    static std::shared_future<bool> requestFont(const std::string& filename);
+    static std::shared_future<bool> requestSoundBuffer(const std::string& filename);
+    static void preload(const AssetManifestEntry* manifest, size_t count);
+
+    // Main thread, once per frame
+    static void update(int maxUploads = 4);
+    static bool isIdle();
+    static void shutdown();
+
 private:
+    template<typename Payload>
+    struct PendingAsset
+    {
+        std::shared_future<bool> ready;
+        std::shared_ptr<Payload> pPayload;
+    };
+
     static inline std::string m_assetPath;
+    // Declared before the asset maps so it is unmapped after everything that reads from it
+    static inline AssetArchive m_archive;
+    static inline std::recursive_mutex m_mutex;
     static inline std::unordered_map<std::string, sf::Font> m_loadedFonts;
     static inline std::unordered_map<std::string, sf::Texture> m_loadedTextures;
     static inline std::unordered_map<std::string, sf::SoundBuffer> m_loadedSoundBuffers;
+    static inline std::unordered_map<std::string, std::unique_ptr<std::vector<char>>> m_fontData;
+    static inline std::unordered_map<std::string, PendingAsset<std::vector<char>>> m_pendingFonts;
+    static inline std::unordered_map<std::string, PendingAsset<sf::Image>> m_pendingTextures;
+    static inline std::unordered_map<std::string, PendingAsset<sf::SoundBuffer>> m_pendingSoundBuffers;
 
     static std::filesystem::path getAssetPath(const std::string& filename);
+    static bool loadTextureFromArchive(sf::Texture& texture, const AssetArchiveEntry& entry);
+
+    static const sf::Font* finishFont(const std::string& filename, const PendingAsset<std::vector<char>>& pending);
+    static const sf::Texture* finishTexture(const std::string& filename, const PendingAsset<sf::Image>& pending);
+    static const sf::SoundBuffer* finishSoundBuffer(const std::string& filename, const PendingAsset<sf::SoundBuffer>& pending);
 };
@@ -0,0 +1,101 @@
+#include "ScoreStore.h"
+#include "core/Log.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+void ScoreStore::init(const std::string& path)
+{
+    s_path = path;
+    load();
+    LOG_INFO("Loaded {} scores from {}", s_entries.size(), s_path.c_str());
+}
+
+void ScoreStore::shutdown()
+{
+    // Let any pending save land before the pool goes away
+    JobSystem::wait(s_saveJobs);
+}
+
+void ScoreStore::load()
+{
+    s_entries.clear();
+    std::ifstream file(s_path);
+    if (!file.is_open())
+        return;
+
+    // One run per line: score, duration, difficulty stage, timestamp. Older files
+    // hold just the best score, which reads as a run with no metadata.
+    std::string line;
+    while (s_entries.size() < MaxEntries && std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        ScoreEntry entry;
+        if (!(fields >> entry.score))
+            continue;
+        fields >> entry.durationSeconds >> entry.difficultyStage >> entry.timestamp;
+        s_entries.push_back(entry);
+    }
+    std::stable_sort(s_entries.begin(), s_entries.end(),
+                     [](const ScoreEntry& a, const ScoreEntry& b) { return a.score > b.score; });
+    s_version++;
+    s_savedVersion = s_version;
+}
+
+int ScoreStore::submit(const ScoreEntry& entry)
+{
+    // Ties go below the runs already on the board
+    auto it = std::upper_bound(s_entries.begin(), s_entries.end(), entry,
+                               [](const ScoreEntry& a, const ScoreEntry& b) { return a.score > b.score; });
+    size_t place = static_cast<size_t>(it - s_entries.begin());
+    if (place >= MaxEntries)
+        return -1;
+
+    s_entries.insert(it, entry);
+    if (s_entries.size() > MaxEntries)
+        s_entries.pop_back();
+    s_version++;
+
+    std::vector<ScoreEntry> entries = s_entries;
+    uint32_t version = s_version;
+    JobSystem::submitTask([entries = std::move(entries), version]() mutable { save(std::move(entries), version); },
+                          &s_saveJobs);
+    return static_cast<int>(place);
+}
+
+void ScoreStore::save(std::vector<ScoreEntry> entries, uint32_t version)
+{
+    std::lock_guard<std::mutex> lock(s_fileMutex);
+    if (version <= s_savedVersion)
+        return;
+
+    std::string tempPath = s_path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Failed to open the temporary file for {}", s_path.c_str());
+            return;
+        }
+        for (const ScoreEntry& entry : entries)
+            file << entry.score << ' ' << entry.durationSeconds << ' ' << entry.difficultyStage << ' '
+                 << entry.timestamp << '\n';
+        file.flush();
+        if (!file)
+        {
+            LOG_ERROR("Failed to write the temporary file for {}", s_path.c_str());
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, s_path, error);
+    if (error)
+    {
+        LOG_ERROR("Failed to replace {} (error {})", s_path.c_str(), error.value());
+        return;
+    }
+    s_savedVersion = version;
+}
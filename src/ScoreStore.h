@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/JobSystem.h"
+
+struct ScoreEntry
+{
+    unsigned int score = 0;
+    float durationSeconds = 0.0f;
+    unsigned int difficultyStage = 0;
+    int64_t timestamp = 0;              // Seconds since the epoch when the run ended
+};
+
+// The leaderboard, loaded once and kept in memory. Submitting a run updates it
+// immediately; the file is rewritten on the job pool, to a temporary that is then
+// renamed over the old one, so a crash mid-write never loses the board. Readers
+// compare getVersion() with the one they last saw instead of polling the file.
+class ScoreStore
+{
+public:
+    static constexpr size_t MaxEntries = 10;
+
+    static void init(const std::string& path = "highscore.txt");
+    static void shutdown();
+
+    // Returns the run's place on the board, or -1 if it did not make it
+    static int submit(const ScoreEntry& entry);
+
+    static unsigned int getHighScore() { return s_entries.empty() ? 0 : s_entries.front().score; }
+    static const std::vector<ScoreEntry>& getEntries() { return s_entries; }
+    static uint32_t getVersion() { return s_version; }
+
+private:
+    static inline std::string s_path;                  // Set once by init(); log records point into it
+    static inline std::vector<ScoreEntry> s_entries;   // Best first; main thread only
+    static inline uint32_t s_version = 0;
+    static inline JobCounter s_saveJobs;
+
+    // Saves can overlap on the pool; the lock orders them and older versions are skipped
+    static inline std::mutex s_fileMutex;
+    static inline uint32_t s_savedVersion = 0;
+
+    static void load();
+    static void save(std::vector<ScoreEntry> entries, uint32_t version);
+};
@@ -0,0 +1,95 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(const sf::Vector2f& worldMin, const sf::Vector2f& worldMax, float cellSize)
+    : m_worldMin(worldMin)
+    , m_invCellSize(1.0f / cellSize)
+    , m_cellsX(std::max(1, static_cast<int>(std::ceil((worldMax.x - worldMin.x) / cellSize))))
+    , m_cellsY(std::max(1, static_cast<int>(std::ceil((worldMax.y - worldMin.y) / cellSize))))
+{
+    m_cellStart.resize(static_cast<size_t>(m_cellsX * m_cellsY) + 1);
+}
+
+int SpatialGrid::cellCoordX(float x) const
+{
+    int cx = static_cast<int>(std::floor((x - m_worldMin.x) * m_invCellSize));
+    return std::clamp(cx, 0, m_cellsX - 1);
+}
+
+int SpatialGrid::cellCoordY(float y) const
+{
+    int cy = static_cast<int>(std::floor((y - m_worldMin.y) * m_invCellSize));
+    return std::clamp(cy, 0, m_cellsY - 1);
+}
+
+void SpatialGrid::build(const sf::Vector2f* positions, const float* radii, size_t count)
+{
+    std::fill(m_cellStart.begin(), m_cellStart.end(), 0u);
+    m_itemCell.resize(count);
+    m_sortedIndices.resize(count);
+    m_sortedPositions.resize(count);
+    m_sortedRadii.resize(count);
+    m_maxRadius = 0.0f;
+
+    // Count items per cell, shifted by one so the prefix sum yields start offsets
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t cell = static_cast<uint32_t>(cellCoordY(positions[i].y) * m_cellsX + cellCoordX(positions[i].x));
+        m_itemCell[i] = cell;
+        m_cellStart[cell + 1]++;
+        m_maxRadius = std::max(m_maxRadius, radii[i]);
+    }
+
+    for (size_t c = 1; c < m_cellStart.size(); ++c)
+        m_cellStart[c] += m_cellStart[c - 1];
+
+    // Scatter into cell order; m_cellStart[cell] is used as the write cursor
+    // and ends up pointing at the start of the next cell, so shift it back after
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t slot = m_cellStart[m_itemCell[i]]++;
+        m_sortedIndices[slot] = static_cast<uint32_t>(i);
+        m_sortedPositions[slot] = positions[i];
+        m_sortedRadii[slot] = radii[i];
+    }
+
+    for (size_t c = m_cellStart.size() - 1; c > 0; --c)
+        m_cellStart[c] = m_cellStart[c - 1];
+    m_cellStart[0] = 0;
+}
+
+size_t SpatialGrid::queryOverlaps(const sf::Vector2f* positions, const float* radii, size_t count,
+                                  std::vector<CollisionPair>& outPairs) const
+{
+    size_t pairsTested = 0;
+    if (m_sortedIndices.empty())
+        return pairsTested;
+
+    for (size_t q = 0; q < count; ++q)
+    {
+        // Items are binned by centre only, so widen the search by the largest item radius
+        const sf::Vector2f& p = positions[q];
+        float reach = radii[q] + m_maxRadius;
+        int minX = cellCoordX(p.x - reach);
+        int maxX = cellCoordX(p.x + reach);
+        int minY = cellCoordY(p.y - reach);
+        int maxY = cellCoordY(p.y + reach);
+
+        for (int cy = minY; cy <= maxY; ++cy)
+        {
+            for (int cx = minX; cx <= maxX; ++cx)
+            {
+                int cell = cy * m_cellsX + cx;
+                for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k)
+                {
+                    ++pairsTested;
+                    float minDistance = radii[q] + m_sortedRadii[k];
+                    if ((p - m_sortedPositions[k]).lengthSquared() <= minDistance * minDistance)
+                        outPairs.push_back({static_cast<uint32_t>(q), m_sortedIndices[k]});
+                }
+            }
+        }
+    }
+    return pairsTested;
+}
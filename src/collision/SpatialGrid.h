@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+struct CollisionPair
+{
+    uint32_t queryIndex;
+    uint32_t itemIndex;
+};
+
+// Uniform grid broad phase. Items are binned by their centre with a counting
+// sort, so a rebuild is linear in the item count and needs no allocation once
+// the internal buffers have grown to their working size.
+class SpatialGrid
+{
+public:
+    SpatialGrid(const sf::Vector2f& worldMin, const sf::Vector2f& worldMax, float cellSize);
+
+    void build(const sf::Vector2f* positions, const float* radii, size_t count);
+
+    // Appends every (query, item) pair whose circles overlap and returns the
+    // number of candidate pairs that had to be tested.
+    size_t queryOverlaps(const sf::Vector2f* positions, const float* radii, size_t count,
+                         std::vector<CollisionPair>& outPairs) const;
+
+    size_t getItemCount() const { return m_sortedIndices.size(); }
+
+private:
+    sf::Vector2f m_worldMin;
+    float m_invCellSize;
+    int m_cellsX;
+    int m_cellsY;
+    float m_maxRadius = 0.0f;
+
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_itemCell;
+    std::vector<uint32_t> m_sortedIndices;
+    std::vector<sf::Vector2f> m_sortedPositions;
+    std::vector<float> m_sortedRadii;
+
+    int cellCoordX(float x) const;
+    int cellCoordY(float y) const;
+};
@@ -0,0 +1,184 @@
+#include "AllocationTracker.h"
+#include "Log.h"
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> s_totalAllocations{0};
+    std::atomic<uint64_t> s_totalBytes{0};
+
+    thread_local uint64_t t_allocations = 0;
+    thread_local uint64_t t_bytes = 0;
+    thread_local uint64_t t_strictViolations = 0;
+    thread_local bool t_strict = false;
+
+    thread_local uint64_t t_frameStartAllocations = 0;
+    thread_local uint64_t t_frameStartBytes = 0;
+    thread_local uint64_t t_frameStartViolations = 0;
+
+#if ALLOCATION_TRACKER_ENABLED
+    void countAllocation(std::size_t size)
+    {
+        s_totalAllocations.fetch_add(1, std::memory_order_relaxed);
+        s_totalBytes.fetch_add(size, std::memory_order_relaxed);
+        t_allocations++;
+        t_bytes += size;
+        if (t_strict)
+        {
+            t_strictViolations++;
+#ifdef ALLOCATION_TRACKER_ASSERT
+            assert(!"Heap allocation in strict frame");
+#endif
+        }
+    }
+
+    void* allocate(std::size_t size)
+    {
+        countAllocation(size);
+        if (size == 0)
+            size = 1;
+        return std::malloc(size);
+    }
+
+    void* allocateAligned(std::size_t size, std::size_t alignment)
+    {
+        countAllocation(size);
+        // aligned_alloc wants the size to be a multiple of the alignment
+        size = (size + alignment - 1) / alignment * alignment;
+#ifdef _MSC_VER
+        return _aligned_malloc(size, alignment);
+#else
+        return std::aligned_alloc(alignment, size);
+#endif
+    }
+
+    void freeAligned(void* p)
+    {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+#endif
+}
+
+void AllocationTracker::beginFrame()
+{
+    t_frameStartAllocations = t_allocations;
+    t_frameStartBytes = t_bytes;
+    t_frameStartViolations = t_strictViolations;
+}
+
+void AllocationTracker::endFrame()
+{
+    s_lastFrame.allocations = t_allocations - t_frameStartAllocations;
+    s_lastFrame.bytes = t_bytes - t_frameStartBytes;
+    s_lastFrame.strictViolations = t_strictViolations - t_frameStartViolations;
+    if (s_lastFrame.strictViolations > 0)
+        LOG_WARN("{} heap allocations ({} bytes) in a strict frame", s_lastFrame.allocations, s_lastFrame.bytes);
+}
+
+AllocationFrameCounts AllocationTracker::getThreadCounts()
+{
+    AllocationFrameCounts counts;
+    counts.allocations = t_allocations;
+    counts.bytes = t_bytes;
+    counts.strictViolations = t_strictViolations;
+    return counts;
+}
+
+void AllocationTracker::addToThread(const AllocationFrameCounts& counts)
+{
+    t_allocations += counts.allocations;
+    t_bytes += counts.bytes;
+    t_strictViolations += counts.strictViolations;
+}
+
+uint64_t AllocationTracker::getTotalAllocations()
+{
+    return s_totalAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationTracker::getTotalBytes()
+{
+    return s_totalBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::setStrict(bool strict)
+{
+    t_strict = strict;
+}
+
+bool AllocationTracker::isStrict()
+{
+    return t_strict;
+}
+
+#if ALLOCATION_TRACKER_ENABLED
+
+void* operator new(std::size_t size)
+{
+    if (void* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* p = allocateAligned(size, static_cast<std::size_t>(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void* p = allocateAligned(size, static_cast<std::size_t>(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+
+#endif
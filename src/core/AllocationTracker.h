@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Replaces the global operator new/delete with counting versions.
+// Build with ALLOCATION_TRACKER_ENABLED=0 to keep the default allocator.
+#ifndef ALLOCATION_TRACKER_ENABLED
+    #define ALLOCATION_TRACKER_ENABLED 1
+#endif
+
+struct AllocationFrameCounts
+{
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t strictViolations = 0;
+};
+
+class AllocationTracker
+{
+public:
+    // Frame counts cover allocations made by the thread that calls beginFrame/endFrame,
+    // including whatever other threads hand over to it through addToThread
+    static void beginFrame();
+    static void endFrame();
+    static const AllocationFrameCounts& getLastFrame() { return s_lastFrame; }
+
+    // Running counts of the calling thread. A thread doing work on another's behalf
+    // takes them before and after, and the other thread adds the difference to its
+    // own with addToThread, so it shows up in that thread's frame.
+    static AllocationFrameCounts getThreadCounts();
+    static void addToThread(const AllocationFrameCounts& counts);
+
+    // Allocations made by every thread since startup
+    static uint64_t getTotalAllocations();
+    static uint64_t getTotalBytes();
+
+    // Strict mode flags every allocation on the calling thread as a violation.
+    // Define ALLOCATION_TRACKER_ASSERT to turn violations into asserts.
+    static void setStrict(bool strict);
+    static bool isStrict();
+
+private:
+    static inline AllocationFrameCounts s_lastFrame;
+};
@@ -0,0 +1,148 @@
+#include "AssetArchive.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetArchive::~AssetArchive()
+{
+    close();
+}
+
+bool AssetArchive::open(const std::filesystem::path& path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!pView)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_pData = static_cast<const uint8_t*>(pView);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* pView = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (pView == MAP_FAILED)
+        return false;
+
+    m_pData = static_cast<const uint8_t*>(pView);
+    m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+    if (!validate())
+    {
+        close();
+        return false;
+    }
+
+    const AssetArchiveHeader* pHeader = reinterpret_cast<const AssetArchiveHeader*>(m_pData);
+    m_entryCount = pHeader->entryCount;
+    m_pEntries = reinterpret_cast<const AssetArchiveEntry*>(m_pData + sizeof(AssetArchiveHeader));
+    return true;
+}
+
+void AssetArchive::close()
+{
+    if (!m_pData)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_pData);
+    CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+    CloseHandle(static_cast<HANDLE>(m_fileHandle));
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_pData), m_size);
+#endif
+
+    m_pData = nullptr;
+    m_size = 0;
+    m_pEntries = nullptr;
+    m_entryCount = 0;
+}
+
+const AssetArchiveEntry* AssetArchive::find(const std::string& name) const
+{
+    const AssetArchiveEntry* pEnd = m_pEntries + m_entryCount;
+    const AssetArchiveEntry* pEntry = std::lower_bound(m_pEntries, pEnd, name, [](const AssetArchiveEntry& entry, const std::string& key)
+    {
+        return std::strncmp(entry.name, key.c_str(), AssetArchiveNameLength) < 0;
+    });
+
+    if (pEntry == pEnd || std::strncmp(pEntry->name, name.c_str(), AssetArchiveNameLength) != 0)
+        return nullptr;
+    return pEntry;
+}
+
+bool AssetArchive::validate() const
+{
+    if (m_size < sizeof(AssetArchiveHeader))
+        return false;
+
+    const AssetArchiveHeader* pHeader = reinterpret_cast<const AssetArchiveHeader*>(m_pData);
+    if (std::memcmp(pHeader->magic, AssetArchiveMagic, sizeof(AssetArchiveMagic)) != 0 || pHeader->version != AssetArchiveVersion)
+        return false;
+
+    size_t indexEnd = sizeof(AssetArchiveHeader) + static_cast<size_t>(pHeader->entryCount) * sizeof(AssetArchiveEntry);
+    if (indexEnd > m_size)
+        return false;
+
+    // A truncated or stale archive is rejected as a whole and the caller falls back to loose files
+    const AssetArchiveEntry* pEntries = reinterpret_cast<const AssetArchiveEntry*>(m_pData + sizeof(AssetArchiveHeader));
+    for (uint32_t i = 0; i < pHeader->entryCount; ++i)
+    {
+        const AssetArchiveEntry& entry = pEntries[i];
+        if (entry.offset < indexEnd || entry.offset > m_size || entry.size > m_size - entry.offset)
+            return false;
+        if (entry.encoding == ASSET_ENCODING_RGBA8 && static_cast<uint64_t>(entry.width) * entry.height * 4 != entry.size)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// On-disk layout of assets.pak, written by tools/assetpack:
+//   AssetArchiveHeader
+//   AssetArchiveEntry[entryCount], sorted by name
+//   blobs, each starting on an AssetArchiveAlignment boundary
+// All fields are little-endian. Blobs are either the original file bytes or,
+// for images packed with --raw-rgba, width * height * 4 bytes of RGBA8.
+static constexpr char AssetArchiveMagic[4] = {'R', 'P', 'A', 'K'};
+static constexpr uint32_t AssetArchiveVersion = 1;
+static constexpr uint32_t AssetArchiveAlignment = 64;
+static constexpr size_t AssetArchiveNameLength = 48;
+
+enum AssetEncoding : uint32_t
+{
+    ASSET_ENCODING_FILE = 0,
+    ASSET_ENCODING_RGBA8 = 1
+};
+
+struct AssetArchiveHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct AssetArchiveEntry
+{
+    char name[AssetArchiveNameLength];
+    uint64_t offset;
+    uint64_t size;
+    uint32_t encoding;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 16, "archive header layout changed");
+static_assert(sizeof(AssetArchiveEntry) == 80, "archive entry layout changed");
+
+// Read-only view of a memory-mapped archive. Blob pointers stay valid until
+// close(), so fonts and other assets that stream from their source memory can
+// keep pointing into the mapping.
+class AssetArchive
+{
+public:
+    AssetArchive() = default;
+    ~AssetArchive();
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return m_pData != nullptr; }
+    uint32_t getEntryCount() const { return m_entryCount; }
+
+    const AssetArchiveEntry* find(const std::string& name) const;
+    const void* getData(const AssetArchiveEntry& entry) const { return m_pData + entry.offset; }
+
+private:
+    bool validate() const;
+
+    const uint8_t* m_pData = nullptr;
+    size_t m_size = 0;
+    const AssetArchiveEntry* m_pEntries = nullptr;
+    uint32_t m_entryCount = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,42 @@
+#include "FrameArena.h"
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+    if (s_buffer.empty())
+        s_buffer.resize(InitialCapacity);
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(s_buffer.data());
+    size_t offset = ((base + s_used + alignment - 1) & ~(alignment - 1)) - base;
+    if (offset + bytes <= s_buffer.size())
+    {
+        s_used = offset + bytes;
+        return s_buffer.data() + offset;
+    }
+
+    // Out of room this frame; the peak is remembered so reset() can grow the buffer
+    s_overflowBlocks.emplace_back(bytes + alignment);
+    s_overflowBytes += bytes + alignment;
+    uintptr_t blockBase = reinterpret_cast<uintptr_t>(s_overflowBlocks.back().data());
+    return reinterpret_cast<void*>((blockBase + alignment - 1) & ~(alignment - 1));
+}
+
+void FrameArena::reset()
+{
+    if (!s_overflowBlocks.empty())
+    {
+        size_t peak = s_used + s_overflowBytes;
+        s_overflowBlocks.clear();
+        s_buffer.assign(peak + peak / 2, 0);
+        s_overflowBytes = 0;
+    }
+    s_used = 0;
+}
+
+FrameArena::Scope::~Scope()
+{
+    // Overflow blocks taken inside a nested scope stay until the next reset
+    if (m_used == 0 && m_overflowBytes == 0)
+        reset();
+    else
+        s_used = m_used;
+}
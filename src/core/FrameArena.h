@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Bump allocator for temporaries that live until the end of the frame.
+// Every thread has its own arena; the main loop resets the main thread's once
+// per frame, and a worker resets its own when its unit of work is done. If a
+// frame outgrows the buffer, the extra requests come from overflow blocks, and
+// the next reset grows the buffer to the peak so later frames stay inside it.
+class FrameArena
+{
+public:
+    static constexpr size_t InitialCapacity = 256 * 1024;
+
+    static void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template<typename T>
+    static T* allocateArray(size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Zero-filled array; handy for per-frame flag masks
+    template<typename T>
+    static T* allocateZeroed(size_t count)
+    {
+        T* p = allocateArray<T>(count);
+        std::memset(p, 0, sizeof(T) * count);
+        return p;
+    }
+
+    static void reset();
+
+    // Hands back what was allocated while it lived. For jobs, which may run on a
+    // thread part-way through work of its own, e.g. the caller of parallelFor()
+    // or a thread helping out in wait(). A scope that began on an empty arena
+    // resets it, so a worker's arena grows after an overflow like the main one.
+    class Scope
+    {
+    public:
+        Scope() : m_used(s_used), m_overflowBytes(s_overflowBytes) {}
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        size_t m_used;
+        size_t m_overflowBytes;
+    };
+
+    static size_t getUsed() { return s_used + s_overflowBytes; }
+    static size_t getCapacity() { return s_buffer.size(); }
+
+private:
+    static inline thread_local std::vector<uint8_t> s_buffer;
+    static inline thread_local size_t s_used = 0;
+    static inline thread_local size_t s_overflowBytes = 0;
+    static inline thread_local std::vector<std::vector<uint8_t>> s_overflowBlocks;
+};
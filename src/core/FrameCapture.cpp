@@ -0,0 +1,224 @@
+#include "FrameCapture.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Telemetry.h"
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/OpenGL.hpp>
+
+FrameCapture::FrameCapture()
+{
+    m_capturedCounter = Telemetry::addCounter("capture_frames");
+    m_droppedCounter = Telemetry::addCounter("capture_dropped");
+}
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+bool FrameCapture::start(const CaptureSettings& settings, sf::Vector2u size)
+{
+    stop();
+    m_settings = settings;
+    m_size = size;
+    uint32_t slotCount = std::max<uint32_t>(settings.slotCount, ReadbackDelayFrames + 1);
+
+    if (settings.format == CAPTURE_FORMAT_RAW_STREAM)
+    {
+        m_pRawFile = std::fopen(settings.path.c_str(), "wb");
+        m_pIndexFile = std::fopen((settings.path + ".txt").c_str(), "w");
+        if (!m_pRawFile || !m_pIndexFile)
+        {
+            // The path is not logged: log arguments are formatted later and must outlive the call
+            LOG_ERROR("Failed to open the capture output files");
+            stop();
+            return false;
+        }
+        std::fprintf(m_pIndexFile, "# %ux%u rgba\n# frame timestamp_ms\n", size.x, size.y);
+    }
+    else
+    {
+        std::error_code error;
+        std::filesystem::create_directories(settings.path, error);
+    }
+
+    // Everything a captured frame needs is allocated here, not per frame
+    m_slots = std::make_unique<Slot[]>(slotCount);
+    m_slotCount = slotCount;
+    for (uint32_t i = 0; i < m_slotCount; ++i)
+    {
+        Slot& slot = m_slots[i];
+        slot.pTexture = std::make_unique<sf::Texture>();
+        if (!slot.pTexture->resize(size))
+        {
+            LOG_ERROR("Failed to create {}x{} capture textures", size.x, size.y);
+            stop();
+            return false;
+        }
+        slot.pixels.resize(static_cast<size_t>(size.x) * size.y * 4);
+    }
+    m_queue.assign(m_slotCount, 0);
+    m_queueHead = 0;
+    m_queueCount = 0;
+    m_runningEncoders = 0;
+    m_nextSlot = 0;
+    m_captureCalls = 0;
+    m_capturedCount = 0;
+    m_droppedCount = 0;
+    m_maxEncoders = settings.format == CAPTURE_FORMAT_RAW_STREAM ? 1 : std::max<uint32_t>(settings.encoderCount, 1);
+
+    m_isCapturing = true;
+    LOG_INFO("Capturing {}x{} frames", size.x, size.y);
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    // Frames still on the GPU need the window to read back, so they are let go
+    for (uint32_t i = 0; i < m_slotCount; ++i)
+    {
+        if (m_slots[i].state.load(std::memory_order_acquire) == SLOT_STATE_COPIED)
+        {
+            m_slots[i].state.store(SLOT_STATE_FREE, std::memory_order_release);
+            m_droppedCount++;
+        }
+    }
+    // Tasks never run on a waiting thread, so this only blocks until workers are done
+    JobSystem::wait(m_encodeJobs);
+
+    if (m_isCapturing)
+    {
+        LOG_INFO("Capture finished: {} frames written, {} dropped", m_capturedCount, m_droppedCount);
+        m_isCapturing = false;
+    }
+    if (m_pRawFile)
+        std::fclose(m_pRawFile);
+    if (m_pIndexFile)
+        std::fclose(m_pIndexFile);
+    m_pRawFile = nullptr;
+    m_pIndexFile = nullptr;
+    m_slots.reset();
+    m_slotCount = 0;
+}
+
+void FrameCapture::capture(sf::RenderWindow& window)
+{
+    if (!m_isCapturing)
+        return;
+
+    PROFILE_SCOPE("FrameCapture::capture");
+    m_captureCalls++;
+
+    // Copies made ReadbackDelayFrames ago have finished on the GPU, so reading them
+    // back is a plain transfer rather than a pipeline flush
+    bool hasReadBack = false;
+    for (uint32_t i = 0; i < m_slotCount; ++i)
+    {
+        uint32_t index = (m_nextSlot + i) % m_slotCount;
+        Slot& slot = m_slots[index];
+        if (slot.state.load(std::memory_order_acquire) != SLOT_STATE_COPIED
+            || slot.capturedFrame + ReadbackDelayFrames > m_captureCalls)
+            continue;
+
+        sf::Texture::bind(slot.pTexture.get());
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, slot.pixels.data());
+        sf::Texture::bind(nullptr);
+        hasReadBack = true;
+
+        slot.state.store(SLOT_STATE_ENCODING, std::memory_order_release);
+        enqueue(index);
+    }
+    if (hasReadBack)
+        window.resetGLStates();
+
+    // Slots are taken strictly in turn, so ring order is capture order; a busy slot
+    // means the encoders are behind and this frame is dropped
+    Slot& slot = m_slots[m_nextSlot];
+    if (window.getSize() != m_size || slot.state.load(std::memory_order_acquire) != SLOT_STATE_FREE)
+    {
+        m_droppedCount++;
+        Telemetry::add(m_droppedCounter, 1.0);
+        return;
+    }
+
+    slot.pTexture->update(window);
+    slot.frame = m_capturedCount++;
+    slot.capturedFrame = m_captureCalls;
+    slot.timestampNs = Profiler::nowNs();
+    slot.state.store(SLOT_STATE_COPIED, std::memory_order_release);
+    m_nextSlot = (m_nextSlot + 1) % m_slotCount;
+    Telemetry::add(m_capturedCounter, 1.0);
+}
+
+void FrameCapture::enqueue(uint32_t slot)
+{
+    bool needsEncoder = false;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue[(m_queueHead + m_queueCount) % m_queue.size()] = slot;
+        m_queueCount++;
+        // A running encoder picks the slot up; another is only started while below the cap
+        if (m_runningEncoders < std::min<size_t>(m_maxEncoders, m_queueCount))
+        {
+            m_runningEncoders++;
+            needsEncoder = true;
+        }
+    }
+    if (needsEncoder)
+    {
+        Job job;
+        job.function = &FrameCapture::runEncoder;
+        job.context = this;
+        JobSystem::submitTask(job, m_encodeJobs);
+    }
+}
+
+void FrameCapture::runEncoder(const Job& job)
+{
+    FrameCapture* pCapture = static_cast<FrameCapture*>(job.context);
+    while (true)
+    {
+        uint32_t index;
+        {
+            std::lock_guard<std::mutex> lock(pCapture->m_queueMutex);
+            if (pCapture->m_queueCount == 0)
+            {
+                pCapture->m_runningEncoders--;
+                return;
+            }
+            index = pCapture->m_queue[pCapture->m_queueHead];
+            pCapture->m_queueHead = (pCapture->m_queueHead + 1) % pCapture->m_queue.size();
+            pCapture->m_queueCount--;
+        }
+
+        Slot& slot = pCapture->m_slots[index];
+        pCapture->encode(slot);
+        slot.state.store(SLOT_STATE_FREE, std::memory_order_release);
+    }
+}
+
+void FrameCapture::encode(Slot& slot)
+{
+    PROFILE_SCOPE("FrameCapture::encode");
+    // Texture rows come back bottom-up
+    size_t rowBytes = static_cast<size_t>(m_size.x) * 4;
+    if (m_settings.format == CAPTURE_FORMAT_RAW_STREAM)
+    {
+        for (size_t row = m_size.y; row-- > 0;)
+            std::fwrite(slot.pixels.data() + row * rowBytes, 1, rowBytes, m_pRawFile);
+        std::fprintf(m_pIndexFile, "%llu %.3f\n", static_cast<unsigned long long>(slot.frame), slot.timestampNs / 1.0e6);
+        return;
+    }
+
+    sf::Image image(m_size, slot.pixels.data());
+    image.flipVertically();
+    char filename[32];
+    std::snprintf(filename, sizeof(filename), "frame_%06llu.png", static_cast<unsigned long long>(slot.frame));
+    if (!image.saveToFile(std::filesystem::path(m_settings.path) / filename))
+        LOG_WARN("Failed to write captured frame {}", slot.frame);
+}
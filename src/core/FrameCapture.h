@@ -0,0 +1,102 @@
+#pragma once
+
+#include "JobSystem.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+namespace sf { class RenderWindow; class Texture; }
+
+enum CaptureFormat
+{
+    CAPTURE_FORMAT_PNG_SEQUENCE = 0,    // path is a directory of frame_NNNNNN.png
+    CAPTURE_FORMAT_RAW_STREAM = 1       // path is one file of bottom-up-corrected RGBA frames, plus path.txt with timestamps
+};
+
+struct CaptureSettings
+{
+    CaptureFormat format = CAPTURE_FORMAT_RAW_STREAM;
+    std::string path = "capture.raw";
+    uint32_t slotCount = 8;             // Frames that can be in flight between the GPU copy and the encoder
+    uint32_t encoderCount = 2;          // PNG only; a raw stream is written in order by one task at a time
+};
+
+// Records what the window shows without stalling the frame. capture() copies
+// the back buffer into a ring texture on the GPU, and the copy from a few frames
+// earlier, long finished by then, is read back into that slot's preallocated
+// pixels. Encoding runs as JobSystem tasks, at most encoderCount at once, each
+// working through the queue until it is empty; tasks only run on workers, so the
+// game's own jobs go first and waiting on them never means encoding. When every
+// slot is still busy the frame is dropped rather than waited for, so the frame
+// times being recorded are not the capture's own.
+class FrameCapture
+{
+public:
+    static constexpr uint32_t ReadbackDelayFrames = 2;
+
+    FrameCapture();
+    ~FrameCapture();
+
+    bool start(const CaptureSettings& settings, sf::Vector2u size);
+    // Waits for the encoders to finish what was read back, then closes the output.
+    // The last ReadbackDelayFrames copies are still on the GPU and are dropped.
+    void stop();
+    bool isCapturing() const { return m_isCapturing; }
+
+    // Call after the frame is drawn and before it is displayed
+    void capture(sf::RenderWindow& window);
+
+    uint64_t getCapturedCount() const { return m_capturedCount; }
+    uint64_t getDroppedCount() const { return m_droppedCount; }
+
+private:
+    enum SlotState : uint8_t
+    {
+        SLOT_STATE_FREE = 0,
+        SLOT_STATE_COPIED = 1,      // On the GPU, waiting for readback
+        SLOT_STATE_ENCODING = 2
+    };
+
+    struct Slot
+    {
+        std::unique_ptr<sf::Texture> pTexture;
+        std::vector<uint8_t> pixels;
+        std::atomic<uint8_t> state{SLOT_STATE_FREE};
+        uint64_t frame = 0;
+        uint64_t capturedFrame = 0;     // capture() call it was taken on; readback waits on this
+        int64_t timestampNs = 0;
+    };
+
+    CaptureSettings m_settings;
+    sf::Vector2u m_size;
+    std::unique_ptr<Slot[]> m_slots;
+    uint32_t m_slotCount = 0;
+    uint32_t m_nextSlot = 0;
+    uint64_t m_captureCalls = 0;
+    uint64_t m_capturedCount = 0;
+    uint64_t m_droppedCount = 0;
+    bool m_isCapturing = false;
+    size_t m_capturedCounter = 0;
+    size_t m_droppedCounter = 0;
+
+    // Slots waiting for an encoder, in capture order; never holds more than m_slotCount
+    std::vector<uint32_t> m_queue;
+    size_t m_queueHead = 0;
+    size_t m_queueCount = 0;
+    std::mutex m_queueMutex;
+    uint32_t m_runningEncoders = 0;     // Encode tasks submitted and not yet out of work
+    uint32_t m_maxEncoders = 0;
+    JobCounter m_encodeJobs;
+
+    FILE* m_pRawFile = nullptr;
+    FILE* m_pIndexFile = nullptr;
+
+    void enqueue(uint32_t slot);
+    static void runEncoder(const Job& job);
+    void encode(Slot& slot);
+};
@@ -0,0 +1,62 @@
+#include "FrameGovernor.h"
+#include "Log.h"
+#include "Telemetry.h"
+
+void FrameGovernor::init(float budgetMs)
+{
+    s_budgetMs = budgetMs;
+    s_smoothedCostMs = 0.0f;
+    s_levelCounter = Telemetry::addCounter("quality_level");
+    s_costCounter = Telemetry::addCounter("frame_cost_ms");
+    s_changeCounter = Telemetry::addCounter("quality_changes");
+}
+
+void FrameGovernor::endFrame(float costMs)
+{
+    // Seed the average with the first sample so startup doesn't read as headroom
+    if (s_smoothedCostMs == 0.0f)
+        s_smoothedCostMs = costMs;
+    else
+        s_smoothedCostMs += (costMs - s_smoothedCostMs) * SmoothingFactor;
+
+    Telemetry::set(s_costCounter, s_smoothedCostMs);
+
+    if (s_cooldownFrames > 0)
+        s_cooldownFrames--;
+    else if (s_forcedLevel == QUALITY_LEVEL_COUNT)
+    {
+        // Separate streaks with a gap between the thresholds, so a cost sitting near
+        // the budget doesn't flip the level back and forth
+        s_overBudgetFrames = s_smoothedCostMs > s_budgetMs ? s_overBudgetFrames + 1 : 0;
+        s_headroomFrames = s_smoothedCostMs < s_budgetMs * RecoverFraction ? s_headroomFrames + 1 : 0;
+
+        if (s_overBudgetFrames >= DegradeFrames && s_level + 1 < QUALITY_LEVEL_COUNT)
+            setLevel(static_cast<QualityLevel>(s_level + 1));
+        else if (s_headroomFrames >= RecoverFrames && s_level > QUALITY_LEVEL_FULL)
+            setLevel(static_cast<QualityLevel>(s_level - 1));
+    }
+
+    Telemetry::set(s_levelCounter, s_level);
+}
+
+void FrameGovernor::setForcedLevel(QualityLevel level)
+{
+    s_forcedLevel = level;
+    if (level != QUALITY_LEVEL_COUNT)
+        setLevel(level);
+}
+
+void FrameGovernor::setLevel(QualityLevel level)
+{
+    if (level == s_level)
+        return;
+
+    LOG_INFO("Quality level {} -> {} (frame cost {} ms, budget {} ms)",
+             static_cast<int>(s_level), static_cast<int>(level), s_smoothedCostMs, s_budgetMs);
+    s_level = level;
+    s_overBudgetFrames = 0;
+    s_headroomFrames = 0;
+    s_cooldownFrames = CooldownFrames;
+    s_changeCount++;
+    Telemetry::add(s_changeCounter, 1.0);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Quality steps, cheapest to notice first. Each level includes the ones below it.
+enum QualityLevel
+{
+    QUALITY_LEVEL_FULL = 0,
+    QUALITY_LEVEL_REDUCED_EFFECTS = 1,     // No per-cell fire flicker
+    QUALITY_LEVEL_REDUCED_SIMULATION = 2,  // Shorter water dispersion, one fire spread roll per cell
+    QUALITY_LEVEL_HALF_RATE = 3,           // Particle world steps every other frame with the summed dt
+    QUALITY_LEVEL_COUNT
+};
+
+// Watches the CPU cost of each frame (update + render, not the present) against
+// a budget and steps the quality level down when the smoothed cost stays over it,
+// then back up once there is clear headroom. The level and the smoothed cost are
+// published as telemetry counters; systems read getLevel() and scale their work.
+class FrameGovernor
+{
+public:
+    static constexpr float SmoothingFactor = 0.1f;     // Weight of the newest frame in the moving average
+    static constexpr float RecoverFraction = 0.7f;     // Step back up once cost stays under this share of the budget
+    static constexpr uint32_t DegradeFrames = 30;      // Frames over budget before stepping down
+    static constexpr uint32_t RecoverFrames = 120;     // Frames with headroom before stepping up
+    static constexpr uint32_t CooldownFrames = 60;     // Settle time after any change
+
+    static void init(float budgetMs);
+    static void endFrame(float costMs);
+
+    static QualityLevel getLevel() { return s_level; }
+    static float getBudgetMs() { return s_budgetMs; }
+    static float getSmoothedCostMs() { return s_smoothedCostMs; }
+    static uint32_t getChangeCount() { return s_changeCount; }
+
+    // Pins the level, for comparing quality steps by hand; pass QUALITY_LEVEL_COUNT to unpin
+    static void setForcedLevel(QualityLevel level);
+
+private:
+    static inline QualityLevel s_level = QUALITY_LEVEL_FULL;
+    static inline QualityLevel s_forcedLevel = QUALITY_LEVEL_COUNT;
+    static inline float s_budgetMs = 16.6f;
+    static inline float s_smoothedCostMs = 0.0f;
+    static inline uint32_t s_overBudgetFrames = 0;
+    static inline uint32_t s_headroomFrames = 0;
+    static inline uint32_t s_cooldownFrames = 0;
+    static inline uint32_t s_changeCount = 0;
+    static inline size_t s_levelCounter = 0;
+    static inline size_t s_costCounter = 0;
+    static inline size_t s_changeCounter = 0;
+
+    static void setLevel(QualityLevel level);
+};
@@ -0,0 +1,280 @@
+#include "Input.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <cstring>
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+namespace
+{
+    struct KeyBinding
+    {
+        sf::Keyboard::Key key;
+        InputAction action;
+    };
+
+    struct ButtonBinding
+    {
+        sf::Mouse::Button button;
+        InputAction action;
+    };
+
+    const KeyBinding KeyBindings[] =
+    {
+        {sf::Keyboard::Key::A, INPUT_ACTION_MOVE_LEFT},
+        {sf::Keyboard::Key::D, INPUT_ACTION_MOVE_RIGHT},
+        {sf::Keyboard::Key::Space, INPUT_ACTION_JUMP},
+        {sf::Keyboard::Key::Escape, INPUT_ACTION_PAUSE},
+        {sf::Keyboard::Key::R, INPUT_ACTION_REWIND},
+        {sf::Keyboard::Key::Enter, INPUT_ACTION_CONFIRM},
+    };
+
+    const ButtonBinding ButtonBindings[] =
+    {
+        {sf::Mouse::Button::Left, INPUT_ACTION_FIRE_FIRE},
+        {sf::Mouse::Button::Right, INPUT_ACTION_FIRE_WATER},
+    };
+
+    // Recordings are raw native-endian fields, meant to be played back on the machine
+    // that made them: the magic, the session seed, then one record per frame
+    const char RecordingMagic[4] = {'R', 'I', 'N', '2'};
+
+    template <typename T>
+    bool readField(FILE* pFile, T& value)
+    {
+        return std::fread(&value, sizeof(T), 1, pFile) == 1;
+    }
+
+    template <typename T>
+    void writeField(FILE* pFile, const T& value)
+    {
+        std::fwrite(&value, sizeof(T), 1, pFile);
+    }
+}
+
+void LiveInputSource::handleEvent(const sf::Event& event)
+{
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>())
+    {
+        for (const KeyBinding& binding : KeyBindings)
+        {
+            if (binding.key == keyPressed->code)
+                push(binding.action, true);
+        }
+    }
+    else if (const auto* keyReleased = event.getIf<sf::Event::KeyReleased>())
+    {
+        for (const KeyBinding& binding : KeyBindings)
+        {
+            if (binding.key == keyReleased->code)
+                push(binding.action, false);
+        }
+    }
+    else if (const auto* buttonPressed = event.getIf<sf::Event::MouseButtonPressed>())
+    {
+        for (const ButtonBinding& binding : ButtonBindings)
+        {
+            if (binding.button == buttonPressed->button)
+                push(binding.action, true);
+        }
+        m_aimPixel = buttonPressed->position;
+    }
+    else if (const auto* buttonReleased = event.getIf<sf::Event::MouseButtonReleased>())
+    {
+        for (const ButtonBinding& binding : ButtonBindings)
+        {
+            if (binding.button == buttonReleased->button)
+                push(binding.action, false);
+        }
+        m_aimPixel = buttonReleased->position;
+    }
+    else if (const auto* mouseMoved = event.getIf<sf::Event::MouseMoved>())
+    {
+        m_aimPixel = mouseMoved->position;
+    }
+    else if (event.is<sf::Event::FocusLost>())
+    {
+        // Releases that happen while unfocused never arrive, so nothing stays held
+        for (int action = 0; action < INPUT_ACTION_COUNT; ++action)
+        {
+            if ((m_held >> action) & 1u)
+                push(static_cast<InputAction>(action), false);
+        }
+    }
+}
+
+void LiveInputSource::push(InputAction action, bool isPressed)
+{
+    // Key repeat sends more presses while a key is held; only changes are actions
+    uint32_t bit = 1u << action;
+    if (((m_held & bit) != 0) == isPressed)
+        return;
+    m_held = isPressed ? (m_held | bit) : (m_held & ~bit);
+
+    InputEvent inputEvent;
+    inputEvent.timestampNs = Profiler::nowNs();
+    inputEvent.action = action;
+    inputEvent.isPressed = isPressed;
+    m_pending.push_back(inputEvent);
+}
+
+bool LiveInputSource::poll(InputFrame& frame)
+{
+    frame.events.insert(frame.events.end(), m_pending.begin(), m_pending.end());
+    frame.aimPixel = m_aimPixel;
+    m_pending.clear();
+    return true;
+}
+
+ReplayInputSource::~ReplayInputSource()
+{
+    if (m_pFile)
+        std::fclose(m_pFile);
+}
+
+bool ReplayInputSource::open(const std::string& path)
+{
+    if (m_pFile)
+        std::fclose(m_pFile);
+    m_pFile = std::fopen(path.c_str(), "rb");
+    if (m_pFile == nullptr)
+    {
+        LOG_ERROR("Failed to open input replay");
+        return false;
+    }
+
+    char magic[sizeof(RecordingMagic)];
+    if (std::fread(magic, sizeof(magic), 1, m_pFile) != 1 || std::memcmp(magic, RecordingMagic, sizeof(magic)) != 0
+        || !readField(m_pFile, m_seed))
+    {
+        LOG_ERROR("Input replay has an unknown format");
+        std::fclose(m_pFile);
+        m_pFile = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool ReplayInputSource::poll(InputFrame& frame)
+{
+    if (m_pFile == nullptr)
+        return false;
+
+    uint32_t eventCount = 0;
+    if (!readField(m_pFile, frame.dt) || !readField(m_pFile, frame.aimPixel.x)
+        || !readField(m_pFile, frame.aimPixel.y) || !readField(m_pFile, eventCount))
+        return false;
+
+    for (uint32_t i = 0; i < eventCount; ++i)
+    {
+        InputEvent inputEvent;
+        uint8_t action = 0;
+        uint8_t isPressed = 0;
+        if (!readField(m_pFile, inputEvent.timestampNs) || !readField(m_pFile, action) || !readField(m_pFile, isPressed)
+            || action >= INPUT_ACTION_COUNT)
+            return false;
+        inputEvent.action = static_cast<InputAction>(action);
+        inputEvent.isPressed = isPressed != 0;
+        frame.events.push_back(inputEvent);
+    }
+    return true;
+}
+
+void Input::setSource(InputSource* pSource)
+{
+    s_pSource = pSource ? pSource : &s_liveSource;
+    s_isSourceActive = true;
+}
+
+const InputSnapshot& Input::beginFrame(float dt)
+{
+    PROFILE_SCOPE("Input::beginFrame");
+    s_frame.dt = dt;
+    s_frame.events.clear();
+    if (!isLive())
+    {
+        // The window still reports events while something else drives the game; they are dropped
+        s_liveSource.poll(s_frame);
+        s_frame.events.clear();
+    }
+
+    if (s_isSourceActive && !s_pSource->poll(s_frame))
+    {
+        s_isSourceActive = false;
+        LOG_INFO("Input source finished");
+    }
+    if (!s_isSourceActive)
+    {
+        // A finished source lets go of everything it was holding
+        s_frame.events.clear();
+        for (int action = 0; action < INPUT_ACTION_COUNT; ++action)
+        {
+            if ((s_snapshot.held >> action) & 1u)
+                s_frame.events.push_back({Profiler::nowNs(), static_cast<InputAction>(action), false});
+        }
+    }
+
+    s_snapshot.dt = s_frame.dt;
+    s_snapshot.aimPixel = s_frame.aimPixel;
+    s_snapshot.pressed = 0;
+    s_snapshot.released = 0;
+    for (const InputEvent& inputEvent : s_frame.events)
+    {
+        uint32_t bit = 1u << inputEvent.action;
+        if (inputEvent.isPressed)
+        {
+            s_snapshot.held |= bit;
+            s_snapshot.pressed |= bit;
+        }
+        else
+        {
+            s_snapshot.held &= ~bit;
+            s_snapshot.released |= bit;
+        }
+    }
+
+    if (s_pRecordFile)
+        writeFrame();
+    return s_snapshot;
+}
+
+bool Input::setRecording(bool recording, const std::string& path)
+{
+    if (recording == isRecording())
+        return true;
+
+    if (recording)
+    {
+        s_pRecordFile = std::fopen(path.c_str(), "wb");
+        if (s_pRecordFile == nullptr)
+        {
+            LOG_ERROR("Failed to open input recording file");
+            return false;
+        }
+        std::fwrite(RecordingMagic, sizeof(RecordingMagic), 1, s_pRecordFile);
+        writeField(s_pRecordFile, s_seed);
+        LOG_INFO("Input recording started");
+    }
+    else
+    {
+        std::fclose(s_pRecordFile);
+        s_pRecordFile = nullptr;
+        LOG_INFO("Input recording stopped");
+    }
+    return true;
+}
+
+void Input::writeFrame()
+{
+    writeField(s_pRecordFile, s_frame.dt);
+    writeField(s_pRecordFile, s_frame.aimPixel.x);
+    writeField(s_pRecordFile, s_frame.aimPixel.y);
+    writeField(s_pRecordFile, static_cast<uint32_t>(s_frame.events.size()));
+    for (const InputEvent& inputEvent : s_frame.events)
+    {
+        writeField(s_pRecordFile, inputEvent.timestampNs);
+        writeField(s_pRecordFile, static_cast<uint8_t>(inputEvent.action));
+        writeField(s_pRecordFile, static_cast<uint8_t>(inputEvent.isPressed));
+    }
+}
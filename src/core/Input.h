@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+namespace sf { class Event; }
+
+// What the game reacts to, independent of which key or button produced it
+enum InputAction : uint8_t
+{
+    INPUT_ACTION_MOVE_LEFT = 0,
+    INPUT_ACTION_MOVE_RIGHT = 1,
+    INPUT_ACTION_JUMP = 2,
+    INPUT_ACTION_FIRE_FIRE = 3,
+    INPUT_ACTION_FIRE_WATER = 4,
+    INPUT_ACTION_PAUSE = 5,
+    INPUT_ACTION_REWIND = 6,
+    INPUT_ACTION_CONFIRM = 7,
+    INPUT_ACTION_COUNT
+};
+
+struct InputEvent
+{
+    int64_t timestampNs = 0;    // When the device reported it, on the Profiler clock
+    InputAction action = INPUT_ACTION_MOVE_LEFT;
+    bool isPressed = false;
+};
+
+// Everything a source hands over for one frame: the actions in the order they
+// happened, where the pointer is and how long the frame was
+struct InputFrame
+{
+    float dt = 0.0f;
+    sf::Vector2i aimPixel;      // Window pixels; the view that maps them belongs to the renderer
+    std::vector<InputEvent> events;
+};
+
+// The action state one step reads. A press and release inside the same frame
+// still counts as down for that frame, so short taps are never lost between polls.
+struct InputSnapshot
+{
+    float dt = 0.0f;
+    uint32_t held = 0;          // Down at the end of the frame
+    uint32_t pressed = 0;       // Went down during the frame
+    uint32_t released = 0;      // Went up during the frame
+    sf::Vector2i aimPixel;
+
+    bool isDown(InputAction action) const { return ((held | pressed) >> action) & 1u; }
+    bool wasPressed(InputAction action) const { return (pressed >> action) & 1u; }
+    bool wasReleased(InputAction action) const { return (released >> action) & 1u; }
+};
+
+class InputSource
+{
+public:
+    virtual ~InputSource() = default;
+
+    // Fills in the frame's events and aim, and may replace its dt. Returns false
+    // once the source has nothing more to give, e.g. at the end of a replay.
+    virtual bool poll(InputFrame& frame) = 0;
+};
+
+// Window events translated through the bindings as they arrive
+class LiveInputSource final : public InputSource
+{
+public:
+    void handleEvent(const sf::Event& event);
+    bool poll(InputFrame& frame) override;
+    // Where the pointer is before any mouse event has said so
+    void setAimPixel(sf::Vector2i aimPixel) { m_aimPixel = aimPixel; }
+
+private:
+    std::vector<InputEvent> m_pending;
+    uint32_t m_held = 0;        // Drops key repeats and releases what is held when focus goes
+    sf::Vector2i m_aimPixel;
+
+    void push(InputAction action, bool isPressed);
+};
+
+// Frames written by Input::setRecording(), played back in order
+class ReplayInputSource final : public InputSource
+{
+public:
+    ~ReplayInputSource();
+
+    bool open(const std::string& path);
+    bool poll(InputFrame& frame) override;
+    // The seed the recorded session ran with
+    uint32_t getSeed() const { return m_seed; }
+
+private:
+    FILE* m_pFile = nullptr;
+    uint32_t m_seed = 0;
+};
+
+// A function driving the game, e.g. a bot for soak tests or a scripted benchmark run
+class ScriptedInputSource final : public InputSource
+{
+public:
+    using Script = std::function<bool(uint64_t frameIndex, InputFrame& frame)>;
+
+    explicit ScriptedInputSource(Script script) : m_script(std::move(script)) {}
+    bool poll(InputFrame& frame) override { return m_script(m_frameIndex++, frame); }
+
+private:
+    Script m_script;
+    uint64_t m_frameIndex = 0;
+};
+
+// The one place the game reads devices from. main feeds window events in as it
+// polls them, beginFrame() asks the current source for the frame and folds its
+// events into a snapshot, and the states read that snapshot instead of polling
+// the keyboard themselves. Nothing downstream needs a window, so a replay or a
+// script can drive a run just as well as a player.
+class Input
+{
+public:
+    static void handleEvent(const sf::Event& event) { s_liveSource.handleEvent(event); }
+    static void setAimPixel(sf::Vector2i aimPixel) { s_liveSource.setAimPixel(aimPixel); }
+
+    // Everything random in a session is seeded from this, so a recording stores it
+    // and a replay sets it back before the game starts
+    static uint32_t getSeed() { return s_seed; }
+    static void setSeed(uint32_t seed) { s_seed = seed; }
+
+    // Replaces the live source until called again with nullptr; not owned
+    static void setSource(InputSource* pSource);
+    static bool isLive() { return s_pSource == &s_liveSource; }
+    // False once a non-live source ran out; the live source never does
+    static bool isSourceActive() { return s_isSourceActive; }
+
+    // dt is the measured frame time, which a replay swaps for the recorded one
+    static const InputSnapshot& beginFrame(float dt);
+    static const InputSnapshot& getSnapshot() { return s_snapshot; }
+    // This frame's actions in arrival order
+    static const std::vector<InputEvent>& getEvents() { return s_frame.events; }
+
+    // Writes every frame's input to a file a ReplayInputSource can play back
+    static bool setRecording(bool recording, const std::string& path = "input.rec");
+    static bool isRecording() { return s_pRecordFile != nullptr; }
+
+private:
+    static inline LiveInputSource s_liveSource;
+    static inline InputSource* s_pSource = &s_liveSource;
+    static inline bool s_isSourceActive = true;
+    static inline InputFrame s_frame;
+    static inline InputSnapshot s_snapshot;
+    static inline FILE* s_pRecordFile = nullptr;
+    static inline uint32_t s_seed = 1;
+
+    static void writeFrame();
+};
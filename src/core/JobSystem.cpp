@@ -0,0 +1,411 @@
+#include "JobSystem.h"
+#include "AllocationTracker.h"
+#include "FrameArena.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Telemetry.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    // Deque slot of the current thread; -1 for threads outside the pool
+    thread_local int t_slot = -1;
+    thread_local uint32_t t_stealSeed = 0x9E3779B9u;
+    // Graph tasks running on this thread, counting one picked up while waiting inside another
+    thread_local int t_graphTaskDepth = 0;
+
+    std::mutex s_sleepMutex;
+    std::condition_variable s_sleepCondition;
+
+    // Tasks wait here, FIFO, until a worker has nothing in the deques
+    std::mutex s_taskMutex;
+    std::deque<Job> s_tasks;
+    std::atomic<uint32_t> s_queuedTasks{0};
+
+    size_t s_jobsRunCounter = 0;
+    size_t s_jobsStolenCounter = 0;
+    size_t s_jobsInlineCounter = 0;
+    size_t s_busyMsCounter = 0;
+
+    uint32_t nextStealRandom()
+    {
+        t_stealSeed ^= t_stealSeed << 13;
+        t_stealSeed ^= t_stealSeed >> 17;
+        t_stealSeed ^= t_stealSeed << 5;
+        return t_stealSeed;
+    }
+}
+
+// Fixed ring under a mutex. Jobs are coarse (a slice of a grid, a collision batch)
+// so a short lock is cheap next to the work, and it keeps stealing obviously correct.
+struct JobSystem::WorkDeque
+{
+    std::mutex mutex;
+    Job jobs[DequeCapacity];
+    size_t front = 0;   // Thieves take from here
+    size_t back = 0;    // The owner pushes and pops here
+
+    bool push(const Job& job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (back - front == DequeCapacity)
+            return false;
+        jobs[back % DequeCapacity] = job;
+        back++;
+        return true;
+    }
+
+    bool pop(Job& job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (back == front)
+            return false;
+        back--;
+        job = jobs[back % DequeCapacity];
+        return true;
+    }
+
+    bool steal(Job& job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (back == front)
+            return false;
+        job = jobs[front % DequeCapacity];
+        front++;
+        return true;
+    }
+};
+
+void JobSystem::init(unsigned workerCount)
+{
+    if (workerCount == 0)
+    {
+        unsigned hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    s_quit = false;
+    s_workerCount = workerCount;
+    s_deques.clear();
+    s_threadStats.clear();
+    for (unsigned i = 0; i <= workerCount; ++i)
+    {
+        s_deques.push_back(new WorkDeque());
+        s_threadStats.emplace_back();
+    }
+    s_threadStats.emplace_back();
+
+    // The caller is the main thread and owns deque 0
+    t_slot = 0;
+    for (unsigned i = 1; i <= workerCount; ++i)
+        s_threads.push_back(new std::thread(&JobSystem::workerMain, i));
+
+    s_jobsRunCounter = Telemetry::addCounter("jobs_run");
+    s_jobsStolenCounter = Telemetry::addCounter("jobs_stolen");
+    s_jobsInlineCounter = Telemetry::addCounter("jobs_inline");
+    s_busyMsCounter = Telemetry::addCounter("jobs_busy_ms");
+    LOG_INFO("Job system started with {} workers", workerCount);
+}
+
+void JobSystem::shutdown()
+{
+    wait(s_frameCounter);
+    wait(s_detachedTasks);
+    {
+        std::lock_guard<std::mutex> lock(s_sleepMutex);
+        s_quit = true;
+    }
+    s_sleepCondition.notify_all();
+    for (std::thread* pThread : s_threads)
+    {
+        pThread->join();
+        delete pThread;
+    }
+    s_threads.clear();
+    for (WorkDeque* pDeque : s_deques)
+        delete pDeque;
+    s_deques.clear();
+    s_workerCount = 0;
+    t_slot = -1;
+}
+
+JobSystem::ThreadStats& JobSystem::statsFor(int slot)
+{
+    return slot >= 0 ? s_threadStats[slot] : s_threadStats.back();
+}
+
+void JobSystem::wake()
+{
+    // Taking the lock orders this against a worker that is just about to sleep
+    {
+        std::lock_guard<std::mutex> lock(s_sleepMutex);
+    }
+    s_sleepCondition.notify_one();
+}
+
+void JobSystem::submit(const Job& job, JobCounter& counter)
+{
+    Job queued = job;
+    queued.counter = &counter;
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (s_workerCount == 0)
+    {
+        statsFor(t_slot).jobsInline.fetch_add(1, std::memory_order_relaxed);
+        execute(queued, t_slot);
+        return;
+    }
+
+    // Outside threads spread their jobs over the workers' deques
+    int slot = t_slot;
+    if (slot < 0)
+        slot = 1 + static_cast<int>(s_nextExternalDeque.fetch_add(1, std::memory_order_relaxed) % s_workerCount);
+
+    if (!s_deques[slot]->push(queued))
+    {
+        statsFor(t_slot).jobsInline.fetch_add(1, std::memory_order_relaxed);
+        execute(queued, t_slot);
+        return;
+    }
+    s_queuedJobs.fetch_add(1, std::memory_order_release);
+    wake();
+}
+
+void JobSystem::submitTask(std::function<void()> task, JobCounter* pCounter)
+{
+    Job job;
+    job.context = new std::function<void()>(std::move(task));
+    job.function = [](const Job& self)
+    {
+        std::function<void()>* pTask = static_cast<std::function<void()>*>(self.context);
+        (*pTask)();
+        delete pTask;
+    };
+    submitTask(job, pCounter ? *pCounter : s_detachedTasks);
+}
+
+void JobSystem::submitTask(const Job& job, JobCounter& counter)
+{
+    Job queued = job;
+    queued.counter = &counter;
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (s_workerCount == 0)
+    {
+        statsFor(t_slot).jobsInline.fetch_add(1, std::memory_order_relaxed);
+        execute(queued, t_slot);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_taskMutex);
+        s_tasks.push_back(queued);
+        s_queuedTasks.fetch_add(1, std::memory_order_release);
+    }
+    wake();
+}
+
+bool JobSystem::findTask(Job& job)
+{
+    if (s_queuedTasks.load(std::memory_order_acquire) == 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(s_taskMutex);
+    if (s_tasks.empty())
+        return false;
+    job = s_tasks.front();
+    s_tasks.pop_front();
+    s_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::findJob(int slot, Job& job)
+{
+    if (s_queuedJobs.load(std::memory_order_acquire) == 0)
+        return false;
+
+    if (slot >= 0 && s_deques[slot]->pop(job))
+    {
+        s_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Start at a random victim so thieves don't all pile onto the same deque
+    size_t dequeCount = s_deques.size();
+    if (dequeCount == 0)
+        return false;
+    size_t start = nextStealRandom() % dequeCount;
+    for (size_t i = 0; i < dequeCount; ++i)
+    {
+        size_t victim = (start + i) % dequeCount;
+        if (static_cast<int>(victim) != slot && s_deques[victim]->steal(job))
+        {
+            s_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            statsFor(slot).jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(const Job& job, int slot)
+{
+    int64_t startNs = Profiler::nowNs();
+    job.function(job);
+    ThreadStats& stats = statsFor(slot);
+    stats.busyNs.fetch_add(static_cast<uint64_t>(Profiler::nowNs() - startNs), std::memory_order_relaxed);
+    stats.jobsRun.fetch_add(1, std::memory_order_relaxed);
+    job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    PROFILE_SCOPE("JobSystem::wait");
+    Job job;
+    while (!counter.isDone())
+    {
+        if (findJob(t_slot, job))
+            execute(job, t_slot);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::workerMain(unsigned slot)
+{
+    t_slot = static_cast<int>(slot);
+    t_stealSeed ^= slot * 0x85EBCA6Bu;
+    Job job;
+    while (true)
+    {
+        // Jobs come first: something is blocked in wait() on them, while tasks are background work
+        if (findJob(t_slot, job) || findTask(job))
+        {
+            execute(job, t_slot);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(s_sleepMutex);
+        auto hasWork = []()
+        {
+            return s_queuedJobs.load(std::memory_order_acquire) > 0 || s_queuedTasks.load(std::memory_order_acquire) > 0;
+        };
+        // Whatever was queued before shutdown still runs, so no counter is left pending
+        if (s_quit && !hasWork())
+            return;
+        s_sleepCondition.wait(lock, [&hasWork]() { return s_quit.load() || hasWork(); });
+    }
+}
+
+void JobSystem::endFrame()
+{
+    {
+        PROFILE_SCOPE("JobSystem::frameWait");
+        wait(s_frameCounter);
+    }
+
+    JobStats total;
+    for (const ThreadStats& stats : s_threadStats)
+    {
+        total.jobsRun += stats.jobsRun.load(std::memory_order_relaxed);
+        total.jobsStolen += stats.jobsStolen.load(std::memory_order_relaxed);
+        total.jobsInline += stats.jobsInline.load(std::memory_order_relaxed);
+        total.busyNs += stats.busyNs.load(std::memory_order_relaxed);
+    }
+    s_lastFrameStats.jobsRun = total.jobsRun - s_totalStats.jobsRun;
+    s_lastFrameStats.jobsStolen = total.jobsStolen - s_totalStats.jobsStolen;
+    s_lastFrameStats.jobsInline = total.jobsInline - s_totalStats.jobsInline;
+    s_lastFrameStats.busyNs = total.busyNs - s_totalStats.busyNs;
+    s_totalStats = total;
+
+    Telemetry::set(s_jobsRunCounter, static_cast<double>(s_lastFrameStats.jobsRun));
+    Telemetry::set(s_jobsStolenCounter, static_cast<double>(s_lastFrameStats.jobsStolen));
+    Telemetry::set(s_jobsInlineCounter, static_cast<double>(s_lastFrameStats.jobsInline));
+    Telemetry::set(s_busyMsCounter, static_cast<double>(s_lastFrameStats.busyNs) / 1e6);
+}
+
+TaskGraph::TaskId TaskGraph::addTask(const char* name, std::function<void()> function)
+{
+    Task& task = m_tasks.emplace_back();
+    task.name = name;
+    task.function = std::move(function);
+    return static_cast<TaskId>(m_tasks.size() - 1);
+}
+
+void TaskGraph::addDependency(TaskId before, TaskId after)
+{
+    m_tasks[before].successors.push_back(after);
+    m_tasks[after].dependencyCount++;
+}
+
+void TaskGraph::queue(TaskId task)
+{
+    Job job;
+    job.function = &TaskGraph::runTask;
+    job.context = this;
+    job.begin = task;
+    JobSystem::submit(job, m_counter);
+}
+
+void TaskGraph::runTask(const Job& job)
+{
+    TaskGraph* pGraph = static_cast<TaskGraph*>(job.context);
+    Task& task = pGraph->m_tasks[job.begin];
+    // The caller's own counts already cover what it runs, and a task nested in
+    // another is covered by the outer one
+    bool isMeasured = t_graphTaskDepth == 0 && std::this_thread::get_id() != pGraph->m_callerThread;
+    bool wasStrict = AllocationTracker::isStrict();
+    AllocationFrameCounts start = AllocationTracker::getThreadCounts();
+    if (isMeasured)
+        AllocationTracker::setStrict(pGraph->m_isCallerStrict);
+    t_graphTaskDepth++;
+    {
+        PROFILE_SCOPE(task.name);
+        FrameArena::Scope arenaScope;
+        task.function();
+    }
+    t_graphTaskDepth--;
+    if (isMeasured)
+    {
+        AllocationFrameCounts end = AllocationTracker::getThreadCounts();
+        pGraph->m_otherAllocations.fetch_add(end.allocations - start.allocations, std::memory_order_relaxed);
+        pGraph->m_otherBytes.fetch_add(end.bytes - start.bytes, std::memory_order_relaxed);
+        pGraph->m_otherStrictViolations.fetch_add(end.strictViolations - start.strictViolations, std::memory_order_relaxed);
+        AllocationTracker::setStrict(wasStrict);
+    }
+
+    // Successors are queued before this job retires, so the graph's counter
+    // can't touch zero while work is still to come
+    for (TaskId successor : task.successors)
+    {
+        if (pGraph->m_tasks[successor].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            pGraph->queue(successor);
+    }
+}
+
+void TaskGraph::run()
+{
+    m_callerThread = std::this_thread::get_id();
+    m_isCallerStrict = AllocationTracker::isStrict();
+    m_otherAllocations.store(0, std::memory_order_relaxed);
+    m_otherBytes.store(0, std::memory_order_relaxed);
+    m_otherStrictViolations.store(0, std::memory_order_relaxed);
+
+    for (Task& task : m_tasks)
+        task.remaining.store(task.dependencyCount, std::memory_order_relaxed);
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+    {
+        if (m_tasks[id].dependencyCount == 0)
+            queue(id);
+    }
+    JobSystem::wait(m_counter);
+
+    AllocationFrameCounts others;
+    others.allocations = m_otherAllocations.load(std::memory_order_relaxed);
+    others.bytes = m_otherBytes.load(std::memory_order_relaxed);
+    others.strictViolations = m_otherStrictViolations.load(std::memory_order_relaxed);
+    AllocationTracker::addToThread(others);
+}
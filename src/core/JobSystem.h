@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Counts the unfinished jobs of a group; JobSystem::wait() returns once it hits zero
+struct JobCounter
+{
+    std::atomic<uint32_t> pending{0};
+
+    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// A unit of work. Trivially copyable so it can live in the deques by value; the
+// context is owned by whoever submitted the job and must outlive it.
+struct Job
+{
+    void (*function)(const Job& job) = nullptr;
+    void* context = nullptr;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    JobCounter* counter = nullptr;
+};
+
+struct JobStats
+{
+    uint64_t jobsRun = 0;
+    uint64_t jobsStolen = 0;    // Run by a thread other than the one whose deque held them
+    uint64_t jobsInline = 0;    // Run straight away by the submitter: no workers, or its deque was full
+    uint64_t busyNs = 0;
+};
+
+// Fixed pool of worker threads, each with its own deque. A thread pushes and pops
+// at the back of its own deque and, when that is empty, steals from the front of
+// another's, so big ranges split early spread out while recent small jobs stay
+// cache-warm. The main thread owns deque 0 and, like any thread blocked in wait(),
+// runs jobs instead of sleeping. Threads outside the pool (the simulation worker,
+// asset callers) may submit and wait too. Tasks are kept apart from jobs: only
+// workers take them, so a thread helping out in wait() never picks up file I/O.
+class JobSystem
+{
+public:
+    static constexpr size_t DequeCapacity = 4096;
+
+    // workerCount 0 picks one worker per hardware thread, less the calling thread
+    static void init(unsigned workerCount = 0);
+    static void shutdown();
+    static unsigned getWorkerCount() { return s_workerCount; }
+
+    static void submit(const Job& job, JobCounter& counter);
+    // Heap-backed task for one-off, possibly blocking work such as asset decoding or
+    // saving; not for per-frame use. Runs on a worker only, or inline without any.
+    // Tasks with no counter are waited for by shutdown().
+    static void submitTask(std::function<void()> task, JobCounter* pCounter = nullptr);
+    // The same without the heap, for a submitter that keeps its own context alive
+    static void submitTask(const Job& job, JobCounter& counter);
+    static void wait(JobCounter& counter);
+
+    // Calls function(begin, end) over [0, count) in slices of grainSize and returns
+    // when all have run. The calling thread takes the first slice itself.
+    template<typename Function>
+    static void parallelFor(uint32_t count, uint32_t grainSize, const Function& function);
+
+    // Jobs submitted against the frame counter may run on past the code that started
+    // them but must finish before the frame ends; endFrame() waits for them, then
+    // folds this frame's stats. Call it before anything those jobs read changes.
+    static JobCounter& getFrameCounter() { return s_frameCounter; }
+    static void endFrame();
+    static const JobStats& getLastFrameStats() { return s_lastFrameStats; }
+
+private:
+    struct WorkDeque;
+    struct alignas(64) ThreadStats
+    {
+        std::atomic<uint64_t> jobsRun{0};
+        std::atomic<uint64_t> jobsStolen{0};
+        std::atomic<uint64_t> jobsInline{0};
+        std::atomic<uint64_t> busyNs{0};
+    };
+
+    static inline std::vector<WorkDeque*> s_deques;
+    static inline std::deque<ThreadStats> s_threadStats;   // One per deque plus one for outside threads
+    static inline std::vector<std::thread*> s_threads;
+    static inline unsigned s_workerCount = 0;
+    static inline std::atomic<uint32_t> s_queuedJobs{0};
+    static inline std::atomic<uint32_t> s_nextExternalDeque{0};
+    static inline std::atomic<bool> s_quit{false};
+    static inline JobCounter s_detachedTasks;
+    static inline JobCounter s_frameCounter;
+    static inline JobStats s_totalStats;
+    static inline JobStats s_lastFrameStats;
+
+    static void workerMain(unsigned slot);
+    static bool findJob(int slot, Job& job);
+    static bool findTask(Job& job);
+    static void execute(const Job& job, int slot);
+    static void wake();
+    static ThreadStats& statsFor(int slot);
+};
+
+// Dependent tasks, built once and run as often as needed. A task is queued the
+// moment the last task it depends on finishes. Tasks picked up by another thread
+// run in the caller's strict allocation mode, and what they allocate is counted
+// as the caller's, so a graph reads like the serial code it replaces.
+class TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+
+    TaskId addTask(const char* name, std::function<void()> function);
+    void addDependency(TaskId before, TaskId after);
+
+    // Blocks until every task has run; the calling thread helps
+    void run();
+
+private:
+    struct Task
+    {
+        const char* name;
+        std::function<void()> function;
+        std::vector<TaskId> successors;
+        uint32_t dependencyCount = 0;
+        std::atomic<uint32_t> remaining{0};
+    };
+
+    std::deque<Task> m_tasks;
+    JobCounter m_counter;
+
+    // Set by run() for the tasks of one pass
+    std::thread::id m_callerThread;
+    bool m_isCallerStrict = false;
+    std::atomic<uint64_t> m_otherAllocations{0};
+    std::atomic<uint64_t> m_otherBytes{0};
+    std::atomic<uint64_t> m_otherStrictViolations{0};
+
+    static void runTask(const Job& job);
+    void queue(TaskId task);
+};
+
+template<typename Function>
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize, const Function& function)
+{
+    grainSize = std::max(grainSize, 1u);
+    if (count <= grainSize || s_workerCount == 0)
+    {
+        if (count > 0)
+            function(0u, count);
+        return;
+    }
+
+    JobCounter counter;
+    Job job;
+    job.function = [](const Job& slice) { (*static_cast<const Function*>(slice.context))(slice.begin, slice.end); };
+    job.context = const_cast<Function*>(&function);
+    for (uint32_t begin = grainSize; begin < count; begin += grainSize)
+    {
+        job.begin = begin;
+        job.end = std::min(count, begin + grainSize);
+        submit(job, counter);
+    }
+    function(0u, grainSize);
+    wait(counter);
+}
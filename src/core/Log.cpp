@@ -0,0 +1,179 @@
+#include "Log.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Single-producer single-consumer ring of fixed-size records
+    struct LogRing
+    {
+        static constexpr size_t Capacity = 1024; // Power of two
+
+        LogRecord records[Capacity];
+        alignas(64) std::atomic<size_t> head{0}; // Next write, owned by the producer
+        alignas(64) std::atomic<size_t> tail{0}; // Next read, owned by the consumer
+
+        bool push(const LogRecord& record)
+        {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) >= Capacity)
+                return false;
+            records[h & (Capacity - 1)] = record;
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(LogRecord& record)
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire))
+                return false;
+            record = records[t & (Capacity - 1)];
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+    };
+
+    const auto s_startTime = std::chrono::steady_clock::now();
+
+    std::mutex s_ringsMutex;
+    std::vector<std::unique_ptr<LogRing>> s_rings;
+    std::atomic<uint64_t> s_dropped{0};
+    std::atomic<bool> s_running{false};
+    std::thread s_thread;
+    thread_local LogRing* t_pRing = nullptr;
+
+    const char* levelName(uint8_t level)
+    {
+        switch (level)
+        {
+            case LOG_LEVEL_DEBUG: return "DEBUG";
+            case LOG_LEVEL_INFO: return "INFO";
+            case LOG_LEVEL_WARN: return "WARN";
+            case LOG_LEVEL_ERROR: return "ERROR";
+            default: return "?";
+        }
+    }
+
+    void appendArg(std::string& out, const LogArg& arg)
+    {
+        char buffer[32];
+        switch (arg.type)
+        {
+            case LogArg::INT: std::snprintf(buffer, sizeof(buffer), "%lld", arg.i); break;
+            case LogArg::UINT: std::snprintf(buffer, sizeof(buffer), "%llu", arg.u); break;
+            case LogArg::FLOAT: std::snprintf(buffer, sizeof(buffer), "%g", arg.f); break;
+            case LogArg::STRING: out += arg.s ? arg.s : "(null)"; return;
+            default: return;
+        }
+        out += buffer;
+    }
+
+    void format(std::string& out, const LogRecord& record)
+    {
+        char prefix[48];
+        std::snprintf(prefix, sizeof(prefix), "[%9.3f] [%s] ", record.timestampNs / 1e9, levelName(record.level));
+        out += prefix;
+
+        size_t argIndex = 0;
+        for (const char* c = record.format; *c; ++c)
+        {
+            if (c[0] == '{' && c[1] == '}' && argIndex < record.argCount)
+            {
+                appendArg(out, record.args[argIndex++]);
+                ++c;
+            }
+            else
+                out += *c;
+        }
+        if (record.suppressed > 0)
+            out += " (+" + std::to_string(record.suppressed) + " suppressed)";
+        out += '\n';
+    }
+
+    // Returns true if anything was written
+    bool drain(std::string& buffer)
+    {
+        buffer.clear();
+        {
+            std::lock_guard<std::mutex> lock(s_ringsMutex);
+            LogRecord record;
+            for (const std::unique_ptr<LogRing>& pRing : s_rings)
+            {
+                while (pRing->pop(record))
+                    format(buffer, record);
+            }
+        }
+        if (buffer.empty())
+            return false;
+        std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+        std::fflush(stdout);
+        return true;
+    }
+
+    void run()
+    {
+        std::string buffer;
+        while (s_running.load(std::memory_order_acquire))
+        {
+            if (!drain(buffer))
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        drain(buffer);
+    }
+}
+
+bool LogCallSite::shouldEmit()
+{
+    int64_t now = Log::nowNs();
+    int64_t windowStart = m_windowStartNs.load(std::memory_order_relaxed);
+    if (now - windowStart >= WindowNs
+        && m_windowStartNs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+        m_countInWindow.store(0, std::memory_order_relaxed);
+
+    if (m_countInWindow.fetch_add(1, std::memory_order_relaxed) < MaxPerWindow)
+        return true;
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Log::init()
+{
+    if (s_running.exchange(true))
+        return;
+    s_thread = std::thread(run);
+}
+
+void Log::shutdown()
+{
+    if (!s_running.exchange(false))
+        return;
+    s_thread.join();
+}
+
+int64_t Log::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_startTime).count();
+}
+
+uint64_t Log::getDroppedCount()
+{
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+void Log::push(const LogRecord& record)
+{
+    if (t_pRing == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(s_ringsMutex);
+        s_rings.push_back(std::make_unique<LogRing>());
+        t_pRing = s_rings.back().get();
+    }
+    if (!t_pRing->push(record))
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+enum LogLevel
+{
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO = 1,
+    LOG_LEVEL_WARN = 2,
+    LOG_LEVEL_ERROR = 3,
+    LOG_LEVEL_NONE = 4
+};
+
+// Calls below this level compile to nothing
+#ifndef LOG_COMPILE_LEVEL
+    #ifdef NDEBUG
+        #define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+    #else
+        #define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+    #endif
+#endif
+
+// Arguments are captured by value and formatted later on the logging thread,
+// so strings must outlive the call: literals, typeid names and the like.
+struct LogArg
+{
+    enum Type : uint8_t { NONE, INT, UINT, FLOAT, STRING };
+
+    Type type = NONE;
+    union
+    {
+        long long i;
+        unsigned long long u;
+        double f;
+        const char* s;
+    };
+};
+
+struct LogRecord
+{
+    static constexpr size_t MaxArgs = 4;
+
+    int64_t timestampNs;
+    const char* format;     // "{}" marks where each argument goes
+    uint32_t suppressed;    // Calls dropped by the rate limiter since the last record from this site
+    uint8_t level;
+    uint8_t argCount;
+    LogArg args[MaxArgs];
+};
+
+// Per call site limiter: at most MaxPerWindow records per window, the rest are counted
+class LogCallSite
+{
+public:
+    static constexpr uint32_t MaxPerWindow = 5;
+    static constexpr int64_t WindowNs = 1000000000;
+
+    bool shouldEmit();
+    uint32_t takeSuppressed() { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_windowStartNs{0};
+    std::atomic<uint32_t> m_countInWindow{0};
+    std::atomic<uint32_t> m_suppressed{0};
+};
+
+// Asynchronous logger. Each producing thread owns a lock-free single-producer
+// ring; a background thread drains all rings, formats and flushes. A full ring
+// drops the record instead of blocking the caller.
+class Log
+{
+public:
+    static void init();
+    static void shutdown();
+
+    static int64_t nowNs();
+    static uint64_t getDroppedCount();
+
+    template<typename... Args>
+    static void write(LogLevel level, uint32_t suppressed, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= LogRecord::MaxArgs, "Too many log arguments");
+        LogRecord record;
+        record.timestampNs = nowNs();
+        record.format = format;
+        record.suppressed = suppressed;
+        record.level = static_cast<uint8_t>(level);
+        record.argCount = static_cast<uint8_t>(sizeof...(Args));
+        size_t index = 0;
+        ((record.args[index++] = makeArg(args)), ...);
+        (void)index;
+        push(record);
+    }
+
+private:
+    template<typename T>
+    static LogArg makeArg(const T& value)
+    {
+        LogArg arg;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            arg.type = LogArg::FLOAT;
+            arg.f = static_cast<double>(value);
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            arg.type = LogArg::INT;
+            arg.i = static_cast<long long>(value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            arg.type = LogArg::UINT;
+            arg.u = static_cast<unsigned long long>(value);
+        }
+        else
+        {
+            static_assert(std::is_convertible_v<T, const char*>, "Unsupported log argument type");
+            arg.type = LogArg::STRING;
+            arg.s = value;
+        }
+        return arg;
+    }
+
+    static void push(const LogRecord& record);
+};
+
+#define LOG_AT(level, ...)                                                  \
+    do                                                                      \
+    {                                                                       \
+        if constexpr ((level) >= LOG_COMPILE_LEVEL)                         \
+        {                                                                   \
+            static LogCallSite logCallSite_;                                \
+            if (logCallSite_.shouldEmit())                                  \
+                Log::write((level), logCallSite_.takeSuppressed(), __VA_ARGS__); \
+        }                                                                   \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
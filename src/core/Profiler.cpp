@@ -0,0 +1,151 @@
+#include "Profiler.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+    struct ThreadEvents
+    {
+        std::mutex mutex;   // Only contended while the main thread collects
+        std::vector<ProfileEvent> events;
+        uint32_t threadId = 0;
+    };
+
+    const auto s_startTime = std::chrono::steady_clock::now();
+
+    std::mutex s_threadsMutex;
+    std::vector<std::unique_ptr<ThreadEvents>> s_threads;
+    thread_local ThreadEvents* t_pEvents = nullptr;
+
+    ThreadEvents& threadEvents()
+    {
+        if (t_pEvents == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(s_threadsMutex);
+            s_threads.push_back(std::make_unique<ThreadEvents>());
+            t_pEvents = s_threads.back().get();
+            t_pEvents->threadId = static_cast<uint32_t>(s_threads.size());
+        }
+        return *t_pEvents;
+    }
+}
+
+int64_t Profiler::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_startTime).count();
+}
+
+void Profiler::updateActive()
+{
+    s_active.store(s_overlayVisible || s_capturing, std::memory_order_relaxed);
+}
+
+void Profiler::setOverlayVisible(bool visible)
+{
+    s_overlayVisible = visible;
+    updateActive();
+}
+
+void Profiler::startCapture()
+{
+    s_captureEvents.clear();
+    s_capturing = true;
+    updateActive();
+    LOG_INFO("Profiler capture started");
+}
+
+bool Profiler::stopCapture(const std::string& path)
+{
+    s_capturing = false;
+    updateActive();
+
+    FILE* pFile = std::fopen(path.c_str(), "w");
+    if (pFile == nullptr)
+    {
+        LOG_ERROR("Failed to open profiler trace file");
+        return false;
+    }
+
+    std::fprintf(pFile, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < s_captureEvents.size(); ++i)
+    {
+        const ProfileEvent& event = s_captureEvents[i];
+        std::fprintf(pFile, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     i == 0 ? "" : ",\n", event.name, event.threadId,
+                     event.startNs / 1000.0, event.durationNs / 1000.0);
+    }
+    std::fprintf(pFile, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    std::fclose(pFile);
+
+    LOG_INFO("Profiler capture written: {} events", s_captureEvents.size());
+    s_captureEvents.clear();
+    return true;
+}
+
+void Profiler::record(const char* name, int64_t startNs, int64_t endNs)
+{
+    ThreadEvents& events = threadEvents();
+    std::lock_guard<std::mutex> lock(events.mutex);
+    events.events.push_back({name, startNs, endNs - startNs, events.threadId});
+}
+
+Profiler::ZoneStats& Profiler::findZone(const char* name)
+{
+    // Zone names are literals, so comparing pointers is enough and there are only a handful
+    for (ZoneStats& zone : s_zoneStats)
+    {
+        if (zone.name == name)
+            return zone;
+    }
+    ZoneStats zone = {};
+    zone.name = name;
+    s_zoneStats.push_back(zone);
+    return s_zoneStats.back();
+}
+
+void Profiler::beginFrame()
+{
+    s_frameStartNs = nowNs();
+}
+
+void Profiler::endFrame()
+{
+    int64_t frameEndNs = nowNs();
+    s_historyCursor = (s_historyCursor + 1) % HistorySize;
+    s_frameHistoryMs[s_historyCursor] = static_cast<float>(frameEndNs - s_frameStartNs) / 1e6f;
+
+    for (ZoneStats& zone : s_zoneStats)
+        zone.historyMs[s_historyCursor] = 0.0f;
+
+    {
+        std::lock_guard<std::mutex> threadsLock(s_threadsMutex);
+        for (const std::unique_ptr<ThreadEvents>& pThread : s_threads)
+        {
+            std::lock_guard<std::mutex> lock(pThread->mutex);
+            for (const ProfileEvent& event : pThread->events)
+            {
+                findZone(event.name).historyMs[s_historyCursor] += static_cast<float>(event.durationNs) / 1e6f;
+                if (s_capturing && s_captureEvents.size() < MaxCaptureEvents)
+                    s_captureEvents.push_back(event);
+            }
+            pThread->events.clear();
+        }
+    }
+
+    for (ZoneStats& zone : s_zoneStats)
+    {
+        float sum = 0.0f;
+        float maxMs = 0.0f;
+        for (float sample : zone.historyMs)
+        {
+            sum += sample;
+            maxMs = std::max(maxMs, sample);
+        }
+        zone.averageMs = sum / HistorySize;
+        zone.maxMs = maxMs;
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compile with PROFILER_ENABLED=0 to strip every zone out of the build
+#ifndef PROFILER_ENABLED
+    #define PROFILER_ENABLED 1
+#endif
+
+struct ProfileEvent
+{
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+    uint32_t threadId;
+};
+
+// Collects scoped zone timings. Zones are only recorded while something
+// consumes them (the overlay or a trace capture); otherwise a zone costs one
+// relaxed atomic load. Each thread appends to its own buffer, which the main
+// thread folds into rolling per-zone statistics once per frame.
+class Profiler
+{
+public:
+    static constexpr size_t HistorySize = 120;
+    static constexpr size_t MaxCaptureEvents = 1 << 20;
+
+    struct ZoneStats
+    {
+        const char* name;
+        float historyMs[HistorySize];
+        float averageMs;
+        float maxMs;
+    };
+
+    static int64_t nowNs();
+    static bool isActive() { return s_active.load(std::memory_order_relaxed); }
+
+    static void setOverlayVisible(bool visible);
+    static bool isOverlayVisible() { return s_overlayVisible; }
+
+    // Trace capture, written as Chrome trace-event JSON (chrome://tracing, Perfetto)
+    static void startCapture();
+    static bool stopCapture(const std::string& path);
+    static bool isCapturing() { return s_capturing; }
+
+    static void beginFrame();
+    static void endFrame();
+    static void record(const char* name, int64_t startNs, int64_t endNs);
+
+    static const std::vector<ZoneStats>& getZoneStats() { return s_zoneStats; }
+    static const float* getFrameHistoryMs() { return s_frameHistoryMs; }
+    static size_t getHistoryCursor() { return s_historyCursor; }
+
+private:
+    static inline std::atomic<bool> s_active{false};
+    static inline bool s_overlayVisible = false;
+    static inline bool s_capturing = false;
+    static inline int64_t s_frameStartNs = 0;
+    static inline size_t s_historyCursor = 0;
+    static inline float s_frameHistoryMs[HistorySize] = {};
+    static inline std::vector<ZoneStats> s_zoneStats;
+    static inline std::vector<ProfileEvent> s_captureEvents;
+
+    static void updateActive();
+    static ZoneStats& findZone(const char* name);
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+        : m_name(name)
+        , m_startNs(Profiler::isActive() ? Profiler::nowNs() : -1)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (m_startNs >= 0)
+            Profiler::record(m_name, m_startNs, Profiler::nowNs());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_startNs;
+};
+
+#if PROFILER_ENABLED
+    #define PROFILE_CONCAT_INNER(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+    #define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+    #define PROFILE_SCOPE(name) ((void)0)
+#endif
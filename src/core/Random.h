@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+// xorshift32. Cheap, and reproducible from its seed, unlike rand(), whose one
+// state is shared by every caller on every thread. Each system that needs to be
+// replayable owns one.
+class Random
+{
+public:
+    static constexpr uint32_t DefaultSeed = 0x9E3779B9u;
+
+    explicit Random(uint32_t seed = DefaultSeed) { setSeed(seed); }
+
+    // xorshift never leaves zero, so zero picks the default
+    void setSeed(uint32_t seed) { m_state = seed != 0 ? seed : DefaultSeed; }
+    // The whole state; setSeed(getState()) carries on exactly where it was
+    uint32_t getState() const { return m_state; }
+
+    uint32_t next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    // [0, 1)
+    float nextFloat() { return static_cast<float>(next() >> 8) / 16777216.0f; }
+    float range(float min, float max) { return min + (max - min) * nextFloat(); }
+
+private:
+    uint32_t m_state = DefaultSeed;
+};
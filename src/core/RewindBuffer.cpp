@@ -0,0 +1,319 @@
+#include "RewindBuffer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // A literal run only ends at this many zero bytes; shorter gaps are cheaper inline
+    const size_t MinZeroRun = 4;
+
+    const std::vector<uint8_t> EmptyPlane;
+
+    void writeVarint(std::vector<uint8_t>& out, size_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    size_t readVarint(const uint8_t*& p)
+    {
+        size_t value = 0;
+        int shift = 0;
+        while (*p & 0x80)
+        {
+            value |= static_cast<size_t>(*p++ & 0x7F) << shift;
+            shift += 7;
+        }
+        value |= static_cast<size_t>(*p++) << shift;
+        return value;
+    }
+}
+
+RewindBuffer::~RewindBuffer()
+{
+    // The encoder works on members that go before it does
+    m_encoder.stop();
+}
+
+void RewindBuffer::init(const RewindSettings& settings, size_t planeCount)
+{
+    m_settings = settings;
+    m_settings.keyframeInterval = std::max<uint32_t>(m_settings.keyframeInterval, 1);
+    m_planeCount = std::min(planeCount, MaxPlanes);
+    if (!m_encoder.isStarted())
+        m_encoder.start([this]() { encodeStaged(); });
+    reset();
+}
+
+void RewindBuffer::reset()
+{
+    m_encoder.wait();
+    while (!m_frames.empty())
+        popBack();
+    for (size_t plane = 0; plane < MaxPlanes; ++plane)
+    {
+        m_previous[plane].clear();
+        m_cursorPlanes[plane].clear();
+    }
+    m_framesSinceKeyframe = 0;
+    m_nextIndex = 0;
+    m_isCursorValid = false;
+}
+
+void RewindBuffer::record(float dt, const RewindPlane* planes)
+{
+    PROFILE_SCOPE("RewindBuffer::record");
+    m_encoder.wait();
+    for (size_t plane = 0; plane < m_planeCount; ++plane)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(planes[plane].data);
+        m_staged[plane].assign(bytes, bytes + planes[plane].size);
+    }
+    m_stagedDt = dt;
+    m_encoder.kick();
+}
+
+bool RewindBuffer::isEmpty()
+{
+    m_encoder.wait();
+    return m_frames.empty();
+}
+
+uint64_t RewindBuffer::getFirstFrame()
+{
+    m_encoder.wait();
+    return m_frames.empty() ? 0 : m_frames.front().index;
+}
+
+uint64_t RewindBuffer::getLastFrame()
+{
+    m_encoder.wait();
+    return m_frames.empty() ? 0 : m_frames.back().index;
+}
+
+void RewindBuffer::encodeStaged()
+{
+    PROFILE_SCOPE("RewindBuffer::encode");
+    Frame frame;
+    if (!m_spareBuffers.empty())
+    {
+        frame.bytes = std::move(m_spareBuffers.back());
+        m_spareBuffers.pop_back();
+    }
+    frame.index = m_nextIndex++;
+    frame.dt = m_stagedDt;
+    frame.isKeyframe = m_framesSinceKeyframe == 0 || m_frames.empty();
+    for (size_t plane = 0; plane < m_planeCount; ++plane)
+    {
+        encodePlane(frame.isKeyframe ? EmptyPlane : m_previous[plane], m_staged[plane], frame.bytes);
+        frame.planeEnds[plane] = frame.bytes.size();
+
+        // The staged copy becomes the reference; the old reference is the next staging buffer
+        std::swap(m_previous[plane], m_staged[plane]);
+    }
+    // A keyframe forced early, e.g. the first one, restarts the count; modulo the interval
+    // so that an interval of 1 makes every frame a keyframe
+    m_framesSinceKeyframe = ((frame.isKeyframe ? 0 : m_framesSinceKeyframe) + 1) % m_settings.keyframeInterval;
+
+    addToTotals(frame, 1);
+    m_frames.push_back(std::move(frame));
+    evict();
+}
+
+void RewindBuffer::encodePlane(const std::vector<uint8_t>& previous, const std::vector<uint8_t>& current,
+                               std::vector<uint8_t>& out)
+{
+    size_t size = current.size();
+    size_t common = std::min(size, previous.size());
+    writeVarint(out, size);
+
+    // Tokens are (zero run, literal length, literal bytes). Zeros seen inside a
+    // literal are held in it until there are enough of them to start a run.
+    size_t zeroRun = 0;
+    size_t pendingZeros = 0;
+    m_literal.clear();
+    auto flush = [&]()
+    {
+        m_literal.resize(m_literal.size() - pendingZeros);
+        writeVarint(out, zeroRun);
+        writeVarint(out, m_literal.size());
+        out.insert(out.end(), m_literal.begin(), m_literal.end());
+        m_literal.clear();
+        zeroRun = pendingZeros;
+        pendingZeros = 0;
+    };
+    auto addZeros = [&](size_t count)
+    {
+        if (m_literal.empty())
+        {
+            zeroRun += count;
+            return;
+        }
+        m_literal.insert(m_literal.end(), count, 0);
+        pendingZeros += count;
+        if (pendingZeros >= MinZeroRun)
+            flush();
+    };
+
+    const uint8_t* prev = previous.data();
+    const uint8_t* cur = current.data();
+    for (size_t begin = 0; begin < size; begin += BlockSize)
+    {
+        size_t end = std::min(begin + BlockSize, size);
+        if (end <= common && std::memcmp(prev + begin, cur + begin, end - begin) == 0)
+        {
+            addZeros(end - begin);
+            continue;
+        }
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint8_t x = i < common ? static_cast<uint8_t>(cur[i] ^ prev[i]) : cur[i];
+            if (x == 0)
+            {
+                addZeros(1);
+            }
+            else
+            {
+                m_literal.push_back(x);
+                pendingZeros = 0;
+            }
+        }
+    }
+
+    // Trailing zeros need no token
+    if (!m_literal.empty())
+        flush();
+}
+
+void RewindBuffer::decodePlane(const uint8_t* data, const uint8_t* end, std::vector<uint8_t>& plane)
+{
+    // Growing zero-fills, matching the encoder reading past the previous size as zeros
+    plane.resize(readVarint(data));
+    uint8_t* out = plane.data();
+    size_t pos = 0;
+    while (data < end)
+    {
+        pos += readVarint(data);
+        size_t literal = readVarint(data);
+        for (size_t i = 0; i < literal; ++i)
+            out[pos + i] ^= data[i];
+        data += literal;
+        pos += literal;
+    }
+}
+
+void RewindBuffer::applyFrame(const Frame& frame)
+{
+    const uint8_t* bytes = frame.bytes.data();
+    for (size_t plane = 0; plane < m_planeCount; ++plane)
+    {
+        if (frame.isKeyframe)
+            m_cursorPlanes[plane].clear();
+        size_t begin = plane == 0 ? 0 : frame.planeEnds[plane - 1];
+        decodePlane(bytes + begin, bytes + frame.planeEnds[plane], m_cursorPlanes[plane]);
+    }
+}
+
+bool RewindBuffer::seek(uint64_t frame)
+{
+    PROFILE_SCOPE("RewindBuffer::seek");
+    m_encoder.wait();
+    if (m_frames.empty() || frame < m_frames.front().index || frame > m_frames.back().index)
+        return false;
+    if (m_isCursorValid && m_cursor == frame)
+        return true;
+
+    size_t target = static_cast<size_t>(frame - m_frames.front().index);
+    size_t keyframe = target;
+    while (!m_frames[keyframe].isKeyframe)
+        --keyframe;
+
+    // Going forward from the last seek beats starting over at the keyframe
+    size_t start = keyframe;
+    if (m_isCursorValid && m_cursor >= m_frames[keyframe].index && m_cursor < frame)
+        start = static_cast<size_t>(m_cursor - m_frames.front().index) + 1;
+
+    for (size_t i = start; i <= target; ++i)
+        applyFrame(m_frames[i]);
+    m_cursor = frame;
+    m_isCursorValid = true;
+    return true;
+}
+
+void RewindBuffer::truncateAtCursor()
+{
+    m_encoder.wait();
+    if (!m_isCursorValid)
+        return;
+
+    while (!m_frames.empty() && m_frames.back().index > m_cursor)
+        popBack();
+    if (m_frames.empty())
+    {
+        reset();
+        return;
+    }
+
+    size_t keyframe = m_frames.size() - 1;
+    while (!m_frames[keyframe].isKeyframe)
+        --keyframe;
+    for (size_t plane = 0; plane < m_planeCount; ++plane)
+        m_previous[plane] = m_cursorPlanes[plane];
+    m_nextIndex = m_cursor + 1;
+    m_framesSinceKeyframe = static_cast<uint32_t>((m_frames.size() - keyframe) % m_settings.keyframeInterval);
+}
+
+void RewindBuffer::popFront()
+{
+    Frame& frame = m_frames.front();
+    addToTotals(frame, -1);
+    frame.bytes.clear();
+    m_spareBuffers.push_back(std::move(frame.bytes));
+    m_frames.pop_front();
+}
+
+void RewindBuffer::popBack()
+{
+    Frame& frame = m_frames.back();
+    addToTotals(frame, -1);
+    frame.bytes.clear();
+    m_spareBuffers.push_back(std::move(frame.bytes));
+    m_frames.pop_back();
+    if (m_frames.empty())
+        m_historySeconds.store(0.0f, std::memory_order_relaxed);
+}
+
+void RewindBuffer::addToTotals(const Frame& frame, int sign)
+{
+    // Only one thread changes these at a time; the atomics are for readers
+    size_t bytes = frame.bytes.size();
+    size_t memoryUsed = m_memoryUsed.load(std::memory_order_relaxed);
+    m_memoryUsed.store(sign > 0 ? memoryUsed + bytes : memoryUsed - bytes, std::memory_order_relaxed);
+    float seconds = m_historySeconds.load(std::memory_order_relaxed);
+    m_historySeconds.store(seconds + sign * frame.dt, std::memory_order_relaxed);
+}
+
+void RewindBuffer::evict()
+{
+    // Deltas are useless without their keyframe, so whole groups go together and
+    // the newest group always stays
+    while (getMemoryUsed() > m_settings.memoryBudget || getHistorySeconds() > m_settings.historySeconds)
+    {
+        size_t nextKeyframe = 1;
+        while (nextKeyframe < m_frames.size() && !m_frames[nextKeyframe].isKeyframe)
+            ++nextKeyframe;
+        if (nextKeyframe == m_frames.size())
+            break;
+
+        for (size_t i = 0; i < nextKeyframe; ++i)
+            popFront();
+    }
+    if (m_isCursorValid && !m_frames.empty() && m_cursor < m_frames.front().index)
+        m_isCursorValid = false;
+}
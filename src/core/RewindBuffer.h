@@ -0,0 +1,108 @@
+#pragma once
+
+#include "WorkerThread.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+struct RewindSettings
+{
+    float historySeconds = 10.0f;               // Older frames are dropped past this
+    size_t memoryBudget = 48 * 1024 * 1024;     // Encoded bytes kept at most
+    uint32_t keyframeInterval = 60;             // Frames between full encodings; bounds the cost of a seek
+};
+
+// A run of bytes recorded every frame, e.g. the particle cells or a flattened
+// entity store. A plane may change size from frame to frame.
+struct RewindPlane
+{
+    const void* data = nullptr;
+    size_t size = 0;
+};
+
+// Recent simulation history as keyframes plus XOR deltas against the previous
+// frame. Deltas are run-length coded as (zero run, literal run) pairs, and blocks
+// that did not change are skipped with one memcmp, so a mostly static world
+// costs a few bytes per frame. record() copies the planes and returns; the
+// encoding runs on a worker. Keyframe groups are evicted whole, oldest first, to
+// stay within the budget. Seeking decodes forward from the nearest keyframe, or
+// from the last seek when that is on the way, so scrubbing costs at most one
+// keyframe interval of deltas per call.
+class RewindBuffer
+{
+public:
+    static constexpr size_t MaxPlanes = 4;
+    static constexpr size_t BlockSize = 1024;
+
+    RewindBuffer() = default;
+    ~RewindBuffer();
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+    void init(const RewindSettings& settings, size_t planeCount);
+    void reset();
+
+    void record(float dt, const RewindPlane* planes);
+
+    // Frame numbers count up from the first record() since the last reset()
+    bool isEmpty();
+    uint64_t getFirstFrame();
+    uint64_t getLastFrame();
+
+    // Decodes a recorded frame; its planes are then readable through getPlane()
+    bool seek(uint64_t frame);
+    const std::vector<uint8_t>& getPlane(size_t plane) const { return m_cursorPlanes[plane]; }
+
+    // Forgets everything after the frame last seeked to, so recording carries on from there
+    void truncateAtCursor();
+
+    // Safe to read while the encoder runs, e.g. for telemetry
+    size_t getMemoryUsed() const { return m_memoryUsed.load(std::memory_order_relaxed); }
+    float getHistorySeconds() const { return m_historySeconds.load(std::memory_order_relaxed); }
+
+private:
+    struct Frame
+    {
+        uint64_t index = 0;
+        float dt = 0.0f;
+        bool isKeyframe = false;
+        std::vector<uint8_t> bytes;
+        size_t planeEnds[MaxPlanes] = {};
+    };
+
+    RewindSettings m_settings;
+    size_t m_planeCount = 0;
+    WorkerThread m_encoder;
+
+    // Written by record(), read by the encoder
+    std::vector<uint8_t> m_staged[MaxPlanes];
+    float m_stagedDt = 0.0f;
+
+    // Encoder state: the last frame it encoded and the literal scratch
+    std::vector<uint8_t> m_previous[MaxPlanes];
+    std::vector<uint8_t> m_literal;
+    uint32_t m_framesSinceKeyframe = 0;
+    uint64_t m_nextIndex = 0;
+
+    std::deque<Frame> m_frames;
+    std::vector<std::vector<uint8_t>> m_spareBuffers;   // Byte buffers of evicted frames, reused
+    std::atomic<size_t> m_memoryUsed{0};
+    std::atomic<float> m_historySeconds{0.0f};
+
+    // Decoder state
+    std::vector<uint8_t> m_cursorPlanes[MaxPlanes];
+    uint64_t m_cursor = 0;
+    bool m_isCursorValid = false;
+
+    void encodeStaged();
+    void encodePlane(const std::vector<uint8_t>& previous, const std::vector<uint8_t>& current,
+                     std::vector<uint8_t>& out);
+    static void decodePlane(const uint8_t* data, const uint8_t* end, std::vector<uint8_t>& plane);
+    void applyFrame(const Frame& frame);
+    void addToTotals(const Frame& frame, int sign);
+    void popFront();
+    void popBack();
+    void evict();
+};
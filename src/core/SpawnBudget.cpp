@@ -0,0 +1,93 @@
+#include "SpawnBudget.h"
+#include "Telemetry.h"
+#include <algorithm>
+#include <string>
+
+size_t SpawnBudget::addPool(const char* name, const SpawnCap& cap)
+{
+    Pool pool;
+    pool.cap = cap;
+    pool.throttledCounter = Telemetry::addCounter((std::string("spawn_") + name + "_throttled").c_str());
+    pool.deniedCounter = Telemetry::addCounter((std::string("spawn_") + name + "_denied").c_str());
+    m_pools.push_back(pool);
+    return m_pools.size() - 1;
+}
+
+void SpawnBudget::beginStep()
+{
+    for (Pool& pool : m_pools)
+    {
+        pool.grantedThisStep = 0;
+        pool.throttledThisStep = 0;
+        pool.deniedThisStep = 0;
+    }
+}
+
+uint32_t SpawnBudget::request(size_t poolIndex, uint32_t live, uint32_t wanted, bool allOrNothing)
+{
+    Pool& pool = m_pools[poolIndex];
+    if (wanted == 0)
+        return 0;
+
+    // Spawns granted earlier this step are not in the caller's live count yet
+    uint32_t current = live + pool.grantedThisStep;
+    uint32_t room = current < pool.cap.hard ? pool.cap.hard - current : 0;
+
+    uint32_t granted = wanted;
+    if (room == 0)
+        granted = 0;
+    else if (current > pool.cap.soft && pool.cap.hard > pool.cap.soft)
+    {
+        float share = static_cast<float>(room) / static_cast<float>(pool.cap.hard - pool.cap.soft);
+        if (allOrNothing)
+        {
+            pool.carry += share;
+            if (pool.carry >= 1.0f)
+                pool.carry -= 1.0f;
+            else
+                granted = 0;
+        }
+        else
+        {
+            float scaled = static_cast<float>(wanted) * share + pool.carry;
+            granted = std::min(wanted, static_cast<uint32_t>(scaled));
+            pool.carry = scaled - static_cast<float>(granted);
+        }
+    }
+    uint32_t throttled = room > 0 ? wanted - granted : 0;
+
+    uint32_t denied = room > 0 ? 0 : wanted;
+    if (granted > room)
+    {
+        denied = allOrNothing ? granted : granted - room;
+        granted -= denied;
+    }
+
+    pool.grantedThisStep += granted;
+    pool.throttledThisStep += throttled;
+    pool.deniedThisStep += denied;
+    pool.totals.requested += wanted;
+    pool.totals.granted += granted;
+    pool.totals.throttled += throttled;
+    pool.totals.denied += denied;
+    return granted;
+}
+
+void SpawnBudget::publishTelemetry() const
+{
+    for (const Pool& pool : m_pools)
+    {
+        Telemetry::set(pool.throttledCounter, pool.throttledThisStep);
+        Telemetry::set(pool.deniedCounter, pool.deniedThisStep);
+    }
+}
+
+void SpawnBudget::reset()
+{
+    for (Pool& pool : m_pools)
+    {
+        pool.totals = SpawnPoolStats();
+        pool.carry = 0.0f;
+    }
+    beginStep();
+}
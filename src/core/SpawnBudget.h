@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Live-count limits for one pool. Below soft everything is granted; between soft
+// and hard the granted share falls linearly to zero; at hard nothing is granted.
+struct SpawnCap
+{
+    uint32_t soft = UINT32_MAX;
+    uint32_t hard = UINT32_MAX;
+};
+
+struct SpawnPoolStats
+{
+    uint64_t requested = 0;
+    uint64_t granted = 0;
+    uint64_t throttled = 0;     // Held back by the soft cap
+    uint64_t denied = 0;        // Held back by the hard cap
+};
+
+// Spawners ask here before adding entities or particles and spawn only what is
+// granted, so the amount of live work stays bounded however far difficulty
+// scales. Each pool publishes its throttled and denied counts per step as
+// telemetry counters named spawn_<pool>_throttled and spawn_<pool>_denied.
+class SpawnBudget
+{
+public:
+    size_t addPool(const char* name, const SpawnCap& cap);
+    void setCap(size_t pool, const SpawnCap& cap) { m_pools[pool].cap = cap; }
+
+    // Call once per step before any request
+    void beginStep();
+
+    // Returns how many of the wanted spawns may go ahead given the pool's current
+    // live count. An all-or-nothing request (a blob, a wave) is granted whole or
+    // not at all; under the soft cap it is granted at the same reduced rate. Only
+    // the pool is touched, so different pools may be asked from different threads.
+    uint32_t request(size_t pool, uint32_t live, uint32_t wanted, bool allOrNothing = false);
+
+    // Pushes this step's throttling counts to Telemetry
+    void publishTelemetry() const;
+
+    const SpawnPoolStats& getTotals(size_t pool) const { return m_pools[pool].totals; }
+    size_t getPoolCount() const { return m_pools.size(); }
+    void reset();
+
+private:
+    struct Pool
+    {
+        SpawnCap cap;
+        SpawnPoolStats totals;
+        uint32_t grantedThisStep = 0;
+        uint32_t throttledThisStep = 0;
+        uint32_t deniedThisStep = 0;
+        float carry = 0.0f;     // Fractional grants owed under the soft cap
+        size_t throttledCounter = 0;
+        size_t deniedCounter = 0;
+    };
+
+    std::vector<Pool> m_pools;
+};
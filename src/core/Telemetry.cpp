@@ -0,0 +1,117 @@
+#include "Telemetry.h"
+#include "Log.h"
+#include <algorithm>
+
+void FrameTimeHistogram::add(float ms)
+{
+    size_t bucket = std::min(static_cast<size_t>(std::max(ms, 0.0f) / BucketMs), BucketCount - 1);
+    m_buckets[bucket]++;
+    m_count++;
+    m_maxMs = std::max(m_maxMs, ms);
+}
+
+void FrameTimeHistogram::reset()
+{
+    std::fill(std::begin(m_buckets), std::end(m_buckets), 0u);
+    m_count = 0;
+    m_maxMs = 0.0f;
+}
+
+float FrameTimeHistogram::percentile(float p) const
+{
+    if (m_count == 0)
+        return 0.0f;
+
+    // Upper edge of the bucket holding the p-th sample
+    uint32_t rank = static_cast<uint32_t>(p / 100.0f * static_cast<float>(m_count - 1)) + 1;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return std::min(static_cast<float>(i + 1) * BucketMs, m_maxMs);
+    }
+    return m_maxMs;
+}
+
+size_t Telemetry::addCounter(const char* name)
+{
+    for (size_t i = 0; i < s_names.size(); ++i)
+    {
+        if (s_names[i] == name)
+            return i;
+    }
+    s_names.push_back(name);
+    s_values.push_back(0.0);
+    s_periodSums.push_back(0.0);
+    return s_names.size() - 1;
+}
+
+void Telemetry::setRecording(bool recording, const std::string& path)
+{
+    if (recording == isRecording())
+        return;
+
+    if (recording)
+    {
+        s_pFile = std::fopen(path.c_str(), "w");
+        if (s_pFile == nullptr)
+        {
+            LOG_ERROR("Failed to open telemetry file");
+            return;
+        }
+        s_headerCounterCount = 0;
+        LOG_INFO("Telemetry recording started");
+    }
+    else
+    {
+        std::fclose(s_pFile);
+        s_pFile = nullptr;
+        LOG_INFO("Telemetry recording stopped");
+    }
+}
+
+void Telemetry::endFrame(float frameSeconds)
+{
+    s_periodHistogram.add(frameSeconds * 1000.0f);
+    for (size_t i = 0; i < s_values.size(); ++i)
+    {
+        s_periodSums[i] += s_values[i];
+        s_values[i] = 0.0;
+    }
+    s_periodFrames++;
+    s_periodElapsed += frameSeconds;
+    s_totalElapsed += frameSeconds;
+
+    if (s_periodElapsed < PeriodSeconds)
+        return;
+
+    if (s_pFile != nullptr)
+        writeRow();
+
+    s_periodHistogram.reset();
+    std::fill(s_periodSums.begin(), s_periodSums.end(), 0.0);
+    s_periodFrames = 0;
+    s_periodElapsed = 0.0f;
+}
+
+void Telemetry::writeRow()
+{
+    // Counters registered after the header was written start a new header
+    if (s_headerCounterCount != s_names.size())
+    {
+        std::fprintf(s_pFile, "time_s,frames,frame_p50_ms,frame_p95_ms,frame_p99_ms,frame_max_ms");
+        for (const std::string& name : s_names)
+            std::fprintf(s_pFile, ",%s", name.c_str());
+        std::fprintf(s_pFile, "\n");
+        s_headerCounterCount = s_names.size();
+    }
+
+    std::fprintf(s_pFile, "%.2f,%u,%.2f,%.2f,%.2f,%.2f", s_totalElapsed, s_periodFrames,
+                 s_periodHistogram.percentile(50.0f), s_periodHistogram.percentile(95.0f),
+                 s_periodHistogram.percentile(99.0f), s_periodHistogram.getMaxMs());
+    for (double sum : s_periodSums)
+        std::fprintf(s_pFile, ",%.2f", sum / s_periodFrames);
+    std::fprintf(s_pFile, "\n");
+    std::fflush(s_pFile);
+}
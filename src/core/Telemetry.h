@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Frame times bucketed at 0.1 ms up to 100 ms; slower frames land in the last bucket
+class FrameTimeHistogram
+{
+public:
+    static constexpr size_t BucketCount = 1000;
+    static constexpr float BucketMs = 0.1f;
+
+    void add(float ms);
+    void reset();
+    float percentile(float p) const;
+    float getMaxMs() const { return m_maxMs; }
+    uint32_t getCount() const { return m_count; }
+
+private:
+    uint32_t m_buckets[BucketCount] = {};
+    uint32_t m_count = 0;
+    float m_maxMs = 0.0f;
+};
+
+// Named per-frame counters plus frame-time percentiles. Counters are set while
+// the frame runs and folded in by endFrame(); while recording, the mean of
+// every counter over each period is appended to a CSV file as one row.
+class Telemetry
+{
+public:
+    static constexpr float PeriodSeconds = 1.0f;
+
+    static size_t addCounter(const char* name);
+    static void set(size_t counter, double value) { s_values[counter] = value; }
+    static void add(size_t counter, double value) { s_values[counter] += value; }
+
+    static void endFrame(float frameSeconds);
+
+    static void setRecording(bool recording, const std::string& path = "telemetry.csv");
+    static bool isRecording() { return s_pFile != nullptr; }
+
+    // Percentiles over the current period
+    static float getFrameTimePercentile(float p) { return s_periodHistogram.percentile(p); }
+
+private:
+    static inline std::vector<std::string> s_names;   // Copied, so callers may pass built names
+    static inline std::vector<double> s_values;
+    static inline std::vector<double> s_periodSums;
+    static inline FrameTimeHistogram s_periodHistogram;
+    static inline float s_periodElapsed = 0.0f;
+    static inline float s_totalElapsed = 0.0f;
+    static inline uint32_t s_periodFrames = 0;
+    static inline size_t s_headerCounterCount = 0;
+    static inline FILE* s_pFile = nullptr;
+
+    static void writeRow();
+};
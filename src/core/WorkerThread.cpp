@@ -0,0 +1,68 @@
+#include "WorkerThread.h"
+
+WorkerThread::~WorkerThread()
+{
+    stop();
+}
+
+void WorkerThread::start(std::function<void()> task)
+{
+    stop();
+    m_task = std::move(task);
+    m_quit = false;
+    m_busy = false;
+    m_thread = std::thread(&WorkerThread::run, this);
+}
+
+void WorkerThread::stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void WorkerThread::kick()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy = true;
+    }
+    m_wake.notify_one();
+}
+
+void WorkerThread::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return !m_busy; });
+}
+
+bool WorkerThread::isBusy()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_busy;
+}
+
+void WorkerThread::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        // A kick that lands together with stop() still runs, so a waiter is never stranded
+        m_wake.wait(lock, [this]() { return m_busy || m_quit; });
+        if (!m_busy)
+            return;
+
+        lock.unlock();
+        m_task();
+        lock.lock();
+
+        m_busy = false;
+        m_done.notify_all();
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// A long-lived thread that runs one fixed task each time it is kicked. The owner
+// kicks, gets on with other work, then waits before touching anything the task
+// writes. Kicking and waiting don't allocate, so this is safe in strict frames.
+class WorkerThread
+{
+public:
+    WorkerThread() = default;
+    ~WorkerThread();
+    WorkerThread(const WorkerThread&) = delete;
+    WorkerThread& operator=(const WorkerThread&) = delete;
+
+    void start(std::function<void()> task);
+    void stop();
+    bool isStarted() const { return m_thread.joinable(); }
+
+    void kick();
+    void wait();
+    bool isBusy();
+
+private:
+    std::function<void()> m_task;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    bool m_busy = false;
+    bool m_quit = false;
+
+    void run();
+};
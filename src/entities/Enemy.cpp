@@ -1,58 +1,53 @@
 #include "Enemy.h"
-#include "ResourceManager.h"
-#include <cmath>
-#include <iostream>
-#include <cstdlib>
-#include <ctime>
-#include <SFML/Graphics/RenderTarget.hpp>
-#include <SFML/Graphics/Sprite.hpp>
-#include "Constants.h"
 
-bool Enemy::init()
+bool EnemyArchetype::applyDamage(size_t row, int damage, int projectileType)
 {
-    int enemyType = rand() % 2;
-    if (enemyType == 0)
-        m_type = ENEMY_TYPE_WATER;
-    else
-        m_type = ENEMY_TYPE_FIRE;
-
-    const sf::Texture* pTexture = nullptr;
-    if (m_type == ENEMY_TYPE_WATER)
-        pTexture = ResourceManager::getOrLoadTexture("ice.png");
-    else
-        pTexture = ResourceManager::getOrLoadTexture("fire.png");
-
-    if (pTexture == nullptr)
-    {
-        std::cout << "ERROR: Failed to load enemy texture!" << std::endl;
-        return false;
-    }
-
-    m_pSprite = std::make_unique<sf::Sprite>(*pTexture);
-    if (!m_pSprite)
-    {
-        std::cout << "ERROR: Failed to create enemy sprite!" << std::endl;
-        return false;
-    }
+    if (projectileType == types[row])
+        healths[row] -= damage;
+    return healths[row] <= 0;
+}
 
-    m_pSprite->setTextureRect(sf::IntRect({0, 0}, {16, 16}));
+void EnemyArchetype::pushBack(const sf::Vector2f& position, int type)
+{
+    positions.push_back(position);
+    radii.push_back(collisionRadius);
+    lifetimes.push_back(0.0f);
+    healths.push_back(EnemyHealth);
+    types.push_back(type);
+}
 
-    sf::FloatRect localBounds = m_pSprite->getLocalBounds();
-    m_pSprite->setOrigin({localBounds.size.x / 2.0f, localBounds.size.y / 2.0f});
-    m_pSprite->setPosition(m_position);
-    m_pSprite->setScale(sf::Vector2f(2.5f, 2.5f));
-    m_collisionRadius = collisionRadius;
+void EnemyArchetype::moveRow(size_t from, size_t to)
+{
+    positions[to] = positions[from];
+    radii[to] = radii[from];
+    lifetimes[to] = lifetimes[from];
+    healths[to] = healths[from];
+    types[to] = types[from];
+}
 
-    return true;
+void EnemyArchetype::popBack()
+{
+    positions.pop_back();
+    radii.pop_back();
+    lifetimes.pop_back();
+    healths.pop_back();
+    types.pop_back();
 }
 
-void Enemy::update(float dt)
+void EnemyArchetype::reserve(size_t count)
 {
-    m_lifetime += dt;
+    positions.reserve(count);
+    radii.reserve(count);
+    lifetimes.reserve(count);
+    healths.reserve(count);
+    types.reserve(count);
 }
 
-void Enemy::render(sf::RenderTarget& target) const
+void EnemyArchetype::clear()
 {
-    m_pSprite->setPosition(m_position);
-    target.draw(*m_pSprite);
+    positions.clear();
+    radii.clear();
+    lifetimes.clear();
+    healths.clear();
+    types.clear();
 }
@@ -1,14 +1,10 @@
 #pragma once
 
-#include "Entity.h"
-#include <memory>
-#include <SFML/Window/Keyboard.hpp>
-#include <SFML/System/Angle.hpp>
-#include <SFML/Graphics/Sprite.hpp>
+#include <cstddef>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
 #include "Constants.h"
 
-namespace sf { class Sprite; }
-
 enum EnemyType
 {
     ENEMY_TYPE_WATER = 0,
@@ -16,33 +12,28 @@ enum EnemyType
     ENEMY_TYPE_WALL = 2
 };
 
-class Enemy final : public Entity
+// All live enemies as parallel component arrays; row i of every array is one enemy.
+// Rows are owned by EntityStore, which keeps them dense and maps handles onto them.
+struct EnemyArchetype
 {
-public:
     static constexpr float collisionRadius = 8.0f;
+    static constexpr float maxLifetime = 5.0f;
+
+    std::vector<sf::Vector2f> positions;
+    std::vector<float> radii;
+    std::vector<float> lifetimes;
+    std::vector<int> healths;
+    std::vector<int> types;
 
-    inline bool setHealth(int damage, int projectileType) { if (projectileType == m_type) m_health -= damage; return isDead(); }
-    inline void setSpeed(float speed) { m_speed = speed; }
-    inline void setDamage(int damage) { m_damage = damage; }
-    
-    inline const float getSpeed() const { return m_speed; }
-    inline const int getHealth() const { return m_health; }
-    inline const int getDamage() const { return m_damage; }
-    inline const int getType() const { return m_type; }
-    inline const bool isDead() const { return m_health <= 0; }
-    inline const bool isExpired() const { return m_lifetime >= 5.0f; }
+    size_t size() const { return positions.size(); }
+    bool isExpired(size_t row) const { return lifetimes[row] >= maxLifetime; }
 
-    Enemy() = default;
-    virtual ~Enemy() = default;
-    
-    bool init() override;
-    void update(float dt) override;
-    void render(sf::RenderTarget& target) const override;
+    // Returns true if the hit killed the enemy; only the matching element does damage
+    bool applyDamage(size_t row, int damage, int projectileType);
 
-private:
-    int m_type;
-    int m_health = EnemyHealth;
-    int m_damage = EnemyDamage;
-    float m_speed = EnemySpeed;
-    float m_lifetime = 0.0f;
+    void pushBack(const sf::Vector2f& position, int type);
+    void moveRow(size_t from, size_t to);
+    void popBack();
+    void reserve(size_t count);
+    void clear();
 };
@@ -1,7 +0,0 @@
-#include "Entity.h"
-
-Entity::Entity(const sf::Vector2f& position, const sf::Angle& rotation)
-    : m_position(position)
-    , m_rotation(rotation)
-{
-}
@@ -0,0 +1,299 @@
+#include "EntityStore.h"
+#include "ResourceManager.h"
+#include "core/FrameArena.h"
+#include "core/Log.h"
+#include "core/Profiler.h"
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <cstring>
+
+namespace
+{
+    const float EnemySpriteSize = 16.0f;
+    const float EnemySpriteScale = 2.5f;
+
+    template<typename T>
+    void appendArray(std::vector<uint8_t>& out, const std::vector<T>& values)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        out.insert(out.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    // Fills values from the reader and advances it; false if the data runs out
+    template<typename T>
+    bool readArray(const uint8_t*& data, const uint8_t* end, std::vector<T>& values, size_t count)
+    {
+        size_t bytes = count * sizeof(T);
+        if (static_cast<size_t>(end - data) < bytes)
+            return false;
+        values.resize(count);
+        std::memcpy(values.data(), data, bytes);
+        data += bytes;
+        return true;
+    }
+
+    void appendQuad(sf::VertexArray& vertices, const sf::Vector2f& center, float halfSize,
+                    const sf::Color& color, float texSize)
+    {
+        sf::Vector2f topLeft(center.x - halfSize, center.y - halfSize);
+        sf::Vector2f topRight(center.x + halfSize, center.y - halfSize);
+        sf::Vector2f bottomLeft(center.x - halfSize, center.y + halfSize);
+        sf::Vector2f bottomRight(center.x + halfSize, center.y + halfSize);
+
+        vertices.append({topLeft, color, {0.0f, 0.0f}});
+        vertices.append({topRight, color, {texSize, 0.0f}});
+        vertices.append({bottomLeft, color, {0.0f, texSize}});
+        vertices.append({bottomLeft, color, {0.0f, texSize}});
+        vertices.append({topRight, color, {texSize, 0.0f}});
+        vertices.append({bottomRight, color, {texSize, texSize}});
+    }
+}
+
+EntityHandle HandleMap::create(uint32_t row)
+{
+    uint32_t slot;
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_slotToRow.size());
+        m_slotToRow.push_back(0);
+        m_generations.push_back(0);
+    }
+
+    m_slotToRow[slot] = row;
+    if (m_rowToSlot.size() <= row)
+        m_rowToSlot.resize(row + 1);
+    m_rowToSlot[row] = slot;
+    return {slot, m_generations[slot]};
+}
+
+void HandleMap::destroyAt(uint32_t row)
+{
+    uint32_t slot = m_rowToSlot[row];
+    m_generations[slot]++;
+    m_freeSlots.push_back(slot);
+}
+
+void HandleMap::moveRow(uint32_t from, uint32_t to)
+{
+    uint32_t slot = m_rowToSlot[from];
+    m_rowToSlot[to] = slot;
+    m_slotToRow[slot] = to;
+}
+
+void HandleMap::clear()
+{
+    // Bump every generation so handles from before the clear read as dead
+    m_freeSlots.clear();
+    for (uint32_t slot = 0; slot < m_generations.size(); ++slot)
+    {
+        m_generations[slot]++;
+        m_freeSlots.push_back(slot);
+    }
+    m_rowToSlot.clear();
+}
+
+bool HandleMap::isAlive(EntityHandle handle) const
+{
+    return handle.slot < m_generations.size() && m_generations[handle.slot] == handle.generation;
+}
+
+EntityHandle HandleMap::handleAt(uint32_t row) const
+{
+    uint32_t slot = m_rowToSlot[row];
+    return {slot, m_generations[slot]};
+}
+
+bool EntityStore::init()
+{
+    m_pEnemyTextures[ENEMY_TYPE_WATER] = ResourceManager::getOrLoadTexture("ice.png");
+    m_pEnemyTextures[ENEMY_TYPE_FIRE] = ResourceManager::getOrLoadTexture("fire.png");
+    for (const sf::Texture* pTexture : m_pEnemyTextures)
+    {
+        if (pTexture == nullptr)
+        {
+            LOG_ERROR("Failed to load enemy texture!");
+            return false;
+        }
+    }
+    return true;
+}
+
+void EntityStore::clear()
+{
+    m_enemies.clear();
+    m_projectiles.clear();
+    m_enemyHandles.clear();
+    m_projectileHandles.clear();
+}
+
+EntityHandle EntityStore::spawnEnemy(const sf::Vector2f& position, int type)
+{
+    uint32_t row = static_cast<uint32_t>(m_enemies.size());
+    m_enemies.pushBack(position, type);
+    return m_enemyHandles.create(row);
+}
+
+EntityHandle EntityStore::spawnProjectile(const sf::Vector2f& position, const sf::Vector2f& velocity, int type)
+{
+    uint32_t row = static_cast<uint32_t>(m_projectiles.size());
+    m_projectiles.pushBack(position, velocity, type);
+    return m_projectileHandles.create(row);
+}
+
+void EntityStore::spawnEnemies(const sf::Vector2f* positions, const int* types, size_t count)
+{
+    m_enemies.reserve(m_enemies.size() + count);
+    for (size_t i = 0; i < count; ++i)
+        spawnEnemy(positions[i], types[i]);
+}
+
+void EntityStore::saveState(std::vector<uint8_t>& out) const
+{
+    out.clear();
+    uint32_t counts[2] = {static_cast<uint32_t>(m_enemies.size()), static_cast<uint32_t>(m_projectiles.size())};
+    const uint8_t* countBytes = reinterpret_cast<const uint8_t*>(counts);
+    out.insert(out.end(), countBytes, countBytes + sizeof(counts));
+
+    appendArray(out, m_enemies.positions);
+    appendArray(out, m_enemies.radii);
+    appendArray(out, m_enemies.lifetimes);
+    appendArray(out, m_enemies.healths);
+    appendArray(out, m_enemies.types);
+    appendArray(out, m_projectiles.positions);
+    appendArray(out, m_projectiles.velocities);
+    appendArray(out, m_projectiles.radii);
+    appendArray(out, m_projectiles.types);
+}
+
+bool EntityStore::loadState(const uint8_t* data, size_t size)
+{
+    const uint8_t* end = data + size;
+    uint32_t counts[2];
+    if (size < sizeof(counts))
+        return false;
+    std::memcpy(counts, data, sizeof(counts));
+    data += sizeof(counts);
+
+    clear();
+    bool ok = readArray(data, end, m_enemies.positions, counts[0])
+        && readArray(data, end, m_enemies.radii, counts[0])
+        && readArray(data, end, m_enemies.lifetimes, counts[0])
+        && readArray(data, end, m_enemies.healths, counts[0])
+        && readArray(data, end, m_enemies.types, counts[0])
+        && readArray(data, end, m_projectiles.positions, counts[1])
+        && readArray(data, end, m_projectiles.velocities, counts[1])
+        && readArray(data, end, m_projectiles.radii, counts[1])
+        && readArray(data, end, m_projectiles.types, counts[1]);
+    if (!ok)
+    {
+        clear();
+        return false;
+    }
+
+    for (uint32_t row = 0; row < counts[0]; ++row)
+        m_enemyHandles.create(row);
+    for (uint32_t row = 0; row < counts[1]; ++row)
+        m_projectileHandles.create(row);
+    return true;
+}
+
+template<typename Archetype>
+void EntityStore::despawnRows(Archetype& archetype, HandleMap& handles, const uint8_t* removed)
+{
+    // Walk backwards so every row past i is already known to survive, then
+    // fill each hole with the last row
+    for (size_t i = archetype.size(); i-- > 0;)
+    {
+        if (!removed[i])
+            continue;
+
+        uint32_t last = static_cast<uint32_t>(archetype.size() - 1);
+        handles.destroyAt(static_cast<uint32_t>(i));
+        if (i != last)
+        {
+            archetype.moveRow(last, i);
+            handles.moveRow(last, static_cast<uint32_t>(i));
+        }
+        archetype.popBack();
+    }
+}
+
+void EntityStore::despawnEnemies(const uint8_t* removed)
+{
+    despawnRows(m_enemies, m_enemyHandles, removed);
+}
+
+void EntityStore::despawnProjectiles(const uint8_t* removed)
+{
+    despawnRows(m_projectiles, m_projectileHandles, removed);
+}
+
+void EntityStore::updateProjectiles(float dt)
+{
+    PROFILE_SCOPE("EntityStore::updateProjectiles");
+    size_t count = m_projectiles.size();
+    sf::Vector2f* positions = m_projectiles.positions.data();
+    const sf::Vector2f* velocities = m_projectiles.velocities.data();
+    for (size_t i = 0; i < count; ++i)
+        positions[i] += velocities[i] * dt;
+
+    uint8_t* removed = FrameArena::allocateArray<uint8_t>(count);
+    for (size_t i = 0; i < count; ++i)
+        removed[i] = m_projectiles.isOffScreen(i);
+    despawnProjectiles(removed);
+}
+
+void EntityStore::updateEnemies(float dt)
+{
+    PROFILE_SCOPE("EntityStore::updateEnemies");
+    size_t count = m_enemies.size();
+    float* lifetimes = m_enemies.lifetimes.data();
+    for (size_t i = 0; i < count; ++i)
+        lifetimes[i] += dt;
+
+    uint8_t* removed = FrameArena::allocateArray<uint8_t>(count);
+    for (size_t i = 0; i < count; ++i)
+        removed[i] = m_enemies.isExpired(i);
+    despawnEnemies(removed);
+}
+
+EntityRenderBatch::EntityRenderBatch()
+{
+    for (sf::VertexArray& vertices : enemies)
+        vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+    projectiles.setPrimitiveType(sf::PrimitiveType::Triangles);
+}
+
+void EntityStore::buildRenderBatch(EntityRenderBatch& batch) const
+{
+    for (sf::VertexArray& vertices : batch.enemies)
+        vertices.clear();
+
+    const float halfSize = EnemySpriteSize * EnemySpriteScale / 2.0f;
+    for (size_t i = 0; i < m_enemies.size(); ++i)
+        appendQuad(batch.enemies[m_enemies.types[i]], m_enemies.positions[i], halfSize, sf::Color::White, EnemySpriteSize);
+
+    batch.projectiles.clear();
+    for (size_t i = 0; i < m_projectiles.size(); ++i)
+    {
+        sf::Color color = (m_projectiles.types[i] == PROJECTILE_TYPE_WATER) ? sf::Color::Blue : sf::Color::Red;
+        appendQuad(batch.projectiles, m_projectiles.positions[i], ProjectileWidth / 2.0f, color, 0.0f);
+    }
+}
+
+void EntityStore::drawRenderBatch(sf::RenderTarget& target, const EntityRenderBatch& batch) const
+{
+    // One draw call per enemy texture and one for all projectiles
+    for (int type = 0; type < EnemyTextureCount; ++type)
+    {
+        if (batch.enemies[type].getVertexCount() > 0)
+            target.draw(batch.enemies[type], sf::RenderStates(m_pEnemyTextures[type]));
+    }
+    if (batch.projectiles.getVertexCount() > 0)
+        target.draw(batch.projectiles);
+}
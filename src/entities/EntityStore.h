@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Enemy.h"
+#include "Projectile.h"
+#include <cstdint>
+#include <vector>
+#include <SFML/Graphics/VertexArray.hpp>
+
+namespace sf { class RenderTarget; class Texture; }
+
+// Stable reference to an entity. Stays valid while rows are shuffled around by
+// despawns, and reports dead once its entity is gone even if the slot is reused.
+struct EntityHandle
+{
+    static constexpr uint32_t InvalidSlot = 0xFFFFFFFFu;
+
+    uint32_t slot = InvalidSlot;
+    uint32_t generation = 0;
+
+    bool isValid() const { return slot != InvalidSlot; }
+};
+
+// Maps handle slots to dense archetype rows and back
+class HandleMap
+{
+public:
+    EntityHandle create(uint32_t row);
+    void destroyAt(uint32_t row);
+    void moveRow(uint32_t from, uint32_t to);
+    void clear();
+
+    bool isAlive(EntityHandle handle) const;
+    uint32_t rowOf(EntityHandle handle) const { return m_slotToRow[handle.slot]; }
+    EntityHandle handleAt(uint32_t row) const;
+
+private:
+    std::vector<uint32_t> m_slotToRow;
+    std::vector<uint32_t> m_generations;
+    std::vector<uint32_t> m_rowToSlot;
+    std::vector<uint32_t> m_freeSlots;
+};
+
+// Vertices for one frame of entities: one batch per enemy texture plus one for
+// all projectiles. Built from the store, then drawn without touching it.
+struct EntityRenderBatch
+{
+    static constexpr int EnemyTextureCount = 2;
+
+    EntityRenderBatch();
+
+    sf::VertexArray enemies[EnemyTextureCount];
+    sf::VertexArray projectiles;
+};
+
+class EntityStore
+{
+public:
+    EntityStore() = default;
+    ~EntityStore() = default;
+
+    bool init();
+    void clear();
+
+    EntityHandle spawnEnemy(const sf::Vector2f& position, int type);
+    EntityHandle spawnProjectile(const sf::Vector2f& position, const sf::Vector2f& velocity, int type);
+    void spawnEnemies(const sf::Vector2f* positions, const int* types, size_t count);
+
+    // Removes every row whose flag is set, in one pass. Flags are indexed by row.
+    void despawnEnemies(const uint8_t* removed);
+    void despawnProjectiles(const uint8_t* removed);
+
+    bool isEnemyAlive(EntityHandle handle) const { return m_enemyHandles.isAlive(handle); }
+    bool isProjectileAlive(EntityHandle handle) const { return m_projectileHandles.isAlive(handle); }
+    uint32_t enemyRow(EntityHandle handle) const { return m_enemyHandles.rowOf(handle); }
+    uint32_t projectileRow(EntityHandle handle) const { return m_projectileHandles.rowOf(handle); }
+
+    // Every component array flattened into bytes, e.g. for the rewind buffer.
+    // Handles are not part of it: loaded rows get fresh ones, so old handles read as dead.
+    void saveState(std::vector<uint8_t>& out) const;
+    bool loadState(const uint8_t* data, size_t size);
+
+    // Systems
+    void updateProjectiles(float dt);
+    void updateEnemies(float dt);
+    void buildRenderBatch(EntityRenderBatch& batch) const;
+    void drawRenderBatch(sf::RenderTarget& target, const EntityRenderBatch& batch) const;
+
+    EnemyArchetype& getEnemies() { return m_enemies; }
+    const EnemyArchetype& getEnemies() const { return m_enemies; }
+    ProjectileArchetype& getProjectiles() { return m_projectiles; }
+    const ProjectileArchetype& getProjectiles() const { return m_projectiles; }
+
+private:
+    static constexpr int EnemyTextureCount = EntityRenderBatch::EnemyTextureCount;
+
+    EnemyArchetype m_enemies;
+    ProjectileArchetype m_projectiles;
+    HandleMap m_enemyHandles;
+    HandleMap m_projectileHandles;
+
+    const sf::Texture* m_pEnemyTextures[EnemyTextureCount] = {};
+
+    template<typename Archetype>
+    static void despawnRows(Archetype& archetype, HandleMap& handles, const uint8_t* removed);
+};
@@ -1,9 +1,9 @@
 #include "Player.h"
 #include "ResourceManager.h"
+#include "core/Input.h"
+#include "core/Profiler.h"
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Sprite.hpp>
-#include <SFML/Window/Mouse.hpp>
-#include <SFML/Graphics/RenderWindow.hpp>
 #include <cmath>
 #include <iostream>
 #include "Constants.h"
@@ -25,7 +25,7 @@ void Player::initPhysics()
 
 sf::Vector2f Player::getShootDirection() const
 {
-    sf::Vector2f direction = m_mousePosition - m_position;
+    sf::Vector2f direction = m_aimPosition - m_position;
     float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
     
     // Normalize the direction
@@ -79,6 +79,24 @@ bool Player::init()
     return true;
 }
 
+void Player::reset()
+{
+    m_rotation = sf::degrees(0);
+    m_isJumping = false;
+    m_shootCooldown = 0.0f;
+    m_hasProjectileRequest = false;
+    m_projectileRequest = ProjectileRequest();
+    m_hasSplashRequest = false;
+    m_splashRequest = SplashRequest();
+    m_aimPosition = {0.0f, 0.0f};
+    m_velocity = {0.0f, 0.0f};
+    m_inWater = false;
+    m_groundLevel = GroundLevel;
+    m_gameTime = 0.0f;
+    velocity = {0.0f, 0.0f};
+    initPhysics();
+}
+
 void Player::updatePhysics(float dt)
 {
 	//Gravity
@@ -100,15 +118,29 @@ void Player::updatePhysics(float dt)
 	// sprite.move(velocity);
 }
 
-void Player::update(float dt)
+PlayerInput Player::readInput(const InputSnapshot& input, const sf::Vector2f& aimPosition)
 {
+    PlayerInput playerInput;
+    playerInput.moveLeft = input.isDown(INPUT_ACTION_MOVE_LEFT);
+    playerInput.moveRight = input.isDown(INPUT_ACTION_MOVE_RIGHT);
+    playerInput.jump = input.isDown(INPUT_ACTION_JUMP);
+    playerInput.fireFire = input.isDown(INPUT_ACTION_FIRE_FIRE);
+    playerInput.fireWater = input.isDown(INPUT_ACTION_FIRE_WATER);
+    playerInput.aimPosition = aimPosition;
+    return playerInput;
+}
+
+void Player::update(float dt, const PlayerInput& input)
+{
+    PROFILE_SCOPE("Player::update");
+    m_aimPosition = input.aimPosition;
     // Check for particle collisions if particle world is available
     m_inWater = false;
     m_groundLevel = GroundLevel;
     bool standingOnGround = false;
     bool touchingSandOrWater = false;
     
-    if (m_pParticleWorldPtr)
+    if (m_pParticleWorld)
     {
         // Check particles below and around the player
         int playerGridX = static_cast<int>(m_position.x / ParticleScale);
@@ -129,7 +161,7 @@ void Player::update(float dt)
                 
                 if (gridX >= 0 && gridX < GRID_WIDTH && gridY >= 0 && gridY < GRID_HEIGHT)
                 {
-                    int matId = m_pParticleWorldPtr->getParticleAt(gridX, gridY).getId();
+                    int matId = m_pParticleWorld->getParticleAt(gridX, gridY).getId();
                     
                     // Check if player is in water
                     if (matId == MAT_ID_WATER)
@@ -184,12 +216,12 @@ void Player::update(float dt)
     standingOnGround = (m_position.y >= m_groundLevel - 1.0f);
     
     // Handle input for horizontal movement
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A))
+    if (input.moveLeft)
     {
         if (velocity.x > -velocityMax)
             velocity.x -= acceleration * dt * 60.0f;
     }
-    else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D))
+    else if (input.moveRight)
     {
         if (velocity.x < velocityMax)
             velocity.x += acceleration * dt * 60.0f; 
@@ -203,7 +235,7 @@ void Player::update(float dt)
         velocity.x -= pushForce;
     }
     
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space))
+    if (input.jump)
     {
         if (standingOnGround)
         {
@@ -212,6 +244,15 @@ void Player::update(float dt)
             if (m_inWater)
                 jumpForce *= 0.6f; // Weaker jump in water
             velocity.y = jumpForce;
+
+            // Kicking off loose ground throws some of it up behind the jump
+            if (touchingSandOrWater)
+            {
+                m_splashRequest.position = m_position + sf::Vector2f(0.0f, collisionRadius);
+                m_splashRequest.velocity = sf::Vector2f(velocity.x * 0.5f, jumpForce * 0.5f);
+                m_splashRequest.radius = collisionRadius * 0.5f;
+                m_hasSplashRequest = true;
+            }
         }
     }
     
@@ -259,18 +300,15 @@ void Player::update(float dt)
         m_position.x = WindowWidth - 100.0f;
 
     // Shooting
-    if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Left))
+    if (input.fireFire)
         shoot(dt, PROJECTILE_TYPE_FIRE);
-    else if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Right))
+    else if (input.fireWater)
         shoot(dt, PROJECTILE_TYPE_WATER);
 }
 
-void Player::render(sf::RenderTarget& target) const
+void Player::render(sf::RenderTarget& target, const sf::Vector2f& position) const
 {
-    if (const sf::RenderWindow* window = dynamic_cast<const sf::RenderWindow*>(&target))
-        m_mousePosition = window->mapPixelToCoords(sf::Mouse::getPosition(*window));
-    
     m_pSprite->setRotation(m_rotation);
-    m_pSprite->setPosition(m_position);
+    m_pSprite->setPosition(position);
     target.draw(*m_pSprite);
 }
@@ -1,16 +1,28 @@
 #pragma once
 
-#include "Entity.h"
 #include <memory>
-#include <SFML/Window/Keyboard.hpp>
+#include <SFML/System/Vector2.hpp>
 #include <SFML/System/Angle.hpp>
 #include <SFML/Graphics/Sprite.hpp>
 #include "particles/ParticleWorld.h"
 #include "Constants.h"
 
-namespace sf { class Sprite; }
+namespace sf { class Sprite; class RenderTarget; }
+struct InputSnapshot;
 
-class Player final : public Entity
+// Everything the player reads from the input in one step, taken on the main
+// thread so the step itself can run anywhere
+struct PlayerInput
+{
+    bool moveLeft = false;
+    bool moveRight = false;
+    bool jump = false;
+    bool fireFire = false;
+    bool fireWater = false;
+    sf::Vector2f aimPosition;   // World coordinates
+};
+
+class Player final
 {
 public:
     static constexpr float collisionRadius = 42.0f;
@@ -21,14 +33,20 @@ public:
         int projectileType;  // Which type of projectile
     };
 
+    // Loose cells the player throws up, e.g. when jumping out of sand or water
+    struct SplashRequest {
+        sf::Vector2f position;
+        sf::Vector2f velocity;  // Pixels per second at the centre
+        float radius;
+    };
+
     Player();
-	virtual ~Player() = default;
+	~Player() = default;
 
 	void initPhysics();
 
-	void setParticleWorld(ParticleWorld* pParticleWorld) { m_pParticleWorld = std::make_unique<ParticleWorld>(*pParticleWorld); }
-
-    void setParticleWorldPointer(ParticleWorld* pParticleWorld) { m_pParticleWorldPtr = pParticleWorld; }
+	// The player only reads the world for ground and water checks; the world is not owned
+	void setParticleWorld(ParticleWorld* pParticleWorld) { m_pParticleWorld = pParticleWorld; }
 
     void setGameTime(float gameTime) { m_gameTime = gameTime; }
 
@@ -39,24 +57,43 @@ public:
     bool hasProjectileRequest() const { return m_hasProjectileRequest; }
     void clearProjectileRequest() { m_hasProjectileRequest = false; }
 
+    const SplashRequest& getSplashRequest() const { return m_splashRequest; }
+    bool hasSplashRequest() const { return m_hasSplashRequest; }
+    void clearSplashRequest() { m_hasSplashRequest = false; }
+
     void shoot(float dt, int type);
 
-    bool init() override;
+    const sf::Vector2f& getPosition() const { return m_position; }
+    void setPosition(const sf::Vector2f& position) { m_position = position; }
+    const float getCollisionRadius() const { return m_collisionRadius; }
+
+    static PlayerInput readInput(const InputSnapshot& input, const sf::Vector2f& aimPosition);
+
+    bool init();
+	// Back to the state right after init(), keeping the sprite and the world pointer
+	void reset();
 	void updatePhysics(float dt);
-	void update(float dt) override;
-	void render(sf::RenderTarget& target) const override;
+	void update(float dt, const PlayerInput& input);
+	void render(sf::RenderTarget& target) const { render(target, m_position); }
+	// Draws at a given position, e.g. from a snapshot, without reading the simulation state
+	void render(sf::RenderTarget& target, const sf::Vector2f& position) const;
 
     bool m_isJumping = false;
 
 private:
-    std::unique_ptr<ParticleWorld> m_pParticleWorld;
-    ParticleWorld* m_pParticleWorldPtr = nullptr;
+    sf::Vector2f m_position;
+    sf::Angle m_rotation;
+    float m_collisionRadius = 0.0f;
+    std::unique_ptr<sf::Sprite> m_pSprite;
+    ParticleWorld* m_pParticleWorld = nullptr;
     float m_shootCooldown = 0.0f;
     float m_attackSpeed = AttackSpeed;
     float m_damage = PlayerDamage;
     bool m_hasProjectileRequest = false;
     ProjectileRequest m_projectileRequest;
-    mutable sf::Vector2f m_mousePosition;
+    bool m_hasSplashRequest = false;
+    SplashRequest m_splashRequest;
+    sf::Vector2f m_aimPosition;
     sf::Vector2f m_velocity = {0.0f, 0.0f};
     bool m_inWater = false;
     float m_groundLevel = GroundLevel;
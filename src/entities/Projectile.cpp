@@ -1,38 +1,48 @@
 #include "Projectile.h"
-#include "Constants.h"
-#include <SFML/Graphics/RenderTarget.hpp>
-#include <iostream>
 
-Projectile::Projectile(const sf::Vector2f& position, const sf::Vector2f& velocity, int projectileType)
+bool ProjectileArchetype::isOffScreen(size_t row) const
 {
-	m_position = position;
-	m_velocity = velocity;
+    const sf::Vector2f& position = positions[row];
+    return position.x < -50 || position.x > WindowWidth + 50 ||
+           position.y < -50 || position.y > WindowHeight + 50;
+}
 
-	m_projectileType = projectileType;
-	
-	// Setup the rectangle
-	m_rectangle.setSize(sf::Vector2f(ProjectileWidth, ProjectileHeight));
-	m_rectangle.setOrigin(sf::Vector2f(ProjectileWidth / 2.0f, ProjectileHeight / 2.0f)); // Center it
-	m_rectangle.setPosition(m_position);
-	if (m_projectileType == PROJECTILE_TYPE_WATER)
-		m_rectangle.setFillColor(sf::Color::Blue);
-	else if (m_projectileType == PROJECTILE_TYPE_FIRE)
-		m_rectangle.setFillColor(sf::Color::Red);
+void ProjectileArchetype::pushBack(const sf::Vector2f& position, const sf::Vector2f& velocity, int type)
+{
+    positions.push_back(position);
+    velocities.push_back(velocity);
+    radii.push_back(collisionRadius);
+    types.push_back(type);
+}
+
+void ProjectileArchetype::moveRow(size_t from, size_t to)
+{
+    positions[to] = positions[from];
+    velocities[to] = velocities[from];
+    radii[to] = radii[from];
+    types[to] = types[from];
 }
 
-void Projectile::update(float dt)
+void ProjectileArchetype::popBack()
 {
-    m_position += m_velocity * dt;
-	m_rectangle.setPosition(m_position);
+    positions.pop_back();
+    velocities.pop_back();
+    radii.pop_back();
+    types.pop_back();
 }
 
-void Projectile::render(sf::RenderTarget& target) const
+void ProjectileArchetype::reserve(size_t count)
 {
-    target.draw(m_rectangle);
+    positions.reserve(count);
+    velocities.reserve(count);
+    radii.reserve(count);
+    types.reserve(count);
 }
 
-bool Projectile::isOffScreen() const
+void ProjectileArchetype::clear()
 {
-    return m_position.x < -50 || m_position.x > WindowWidth + 50 ||
-           m_position.y < -50 || m_position.y > WindowHeight + 50;
+    positions.clear();
+    velocities.clear();
+    radii.clear();
+    types.clear();
 }
@@ -1,10 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
 #include <SFML/System/Vector2.hpp>
-#include <SFML/Graphics/CircleShape.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
-
-namespace sf { class RenderTarget; }
+#include "Constants.h"
 
 enum ProjectileType
 {
@@ -12,22 +11,22 @@ enum ProjectileType
 	PROJECTILE_TYPE_FIRE = 1
 };
 
-class Projectile
+// All live projectiles as parallel component arrays, owned by EntityStore
+struct ProjectileArchetype
 {
-public:
-    Projectile(const sf::Vector2f& position, const sf::Vector2f& velocity, int projectileType);
-    
-    inline const sf::Vector2f& getPosition() const { return m_position; }
-	inline const int getProjectileType() const { return m_projectileType; } 
-    bool isOffScreen() const;
+    static inline const float collisionRadius = ProjectileWidth / 2.0f;
+
+    std::vector<sf::Vector2f> positions;
+    std::vector<sf::Vector2f> velocities;
+    std::vector<float> radii;
+    std::vector<int> types;
+
+    size_t size() const { return positions.size(); }
+    bool isOffScreen(size_t row) const;
 
-    void update(float dt);
-    void render(sf::RenderTarget& target) const;
-    
-    
-private:
-	sf::RectangleShape m_rectangle;
-    sf::Vector2f m_position;
-    sf::Vector2f m_velocity;
-	int m_projectileType;
+    void pushBack(const sf::Vector2f& position, const sf::Vector2f& velocity, int type);
+    void moveRow(size_t from, size_t to);
+    void popBack();
+    void reserve(size_t count);
+    void clear();
 };
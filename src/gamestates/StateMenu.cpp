@@ -2,11 +2,27 @@
 #include "StatePlaying.h"
 #include "StateStack.h"
 #include "ResourceManager.h"
+#include "ScoreStore.h"
+#include "core/Input.h"
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Font.hpp>
-#include <SFML/Graphics/Text.hpp>
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    // Everything StatePlaying needs on its first frame; decoded on worker threads
+    // while the menu is up so starting a run never waits on disk
+    const AssetManifestEntry PlayingManifest[] =
+    {
+        {ASSET_TYPE_TEXTURE, "player.png"},
+        {ASSET_TYPE_TEXTURE, "ice.png"},
+        {ASSET_TYPE_TEXTURE, "fire.png"},
+    };
+
+    const size_t LeaderboardRows = 5;
+}
 
 StateMenu::StateMenu(StateStack& stateStack)
     : m_stateStack(stateStack)
@@ -20,81 +36,63 @@ bool StateMenu::init()
     if (pFont == nullptr)
         return false;
 
-    // Load high score
-    m_highScore = loadHighScore();
+    ResourceManager::preload(PlayingManifest, sizeof(PlayingManifest) / sizeof(PlayingManifest[0]));
 
-    m_pText = std::make_unique<sf::Text>(*pFont);
-    if (!m_pText)
-        return false;
-
-    m_pText->setString("IN A WORLD FULL OF TRASH\nWE MUST SURVIVE\nTHERE IS NO CHOICE\n\n\nW A S D TO MOVE\nMOUSE TO AIM \nLEFT CLICK TO SHOOT FIRE\nRIGHT CLICK TO SHOOT ICE\nDESTROY ENEMIES WITH THE CORRECT ELEMENT TO SCORE POINTS\n\nAND ALSO... TRY TO AVOID TRASH :)\n\n\nPRESS <ENTER> TO START");
-    m_pText->setStyle(sf::Text::Bold);
-    sf::FloatRect localBounds = m_pText->getLocalBounds();
-    m_pText->setOrigin({localBounds.size.x / 2.0f, localBounds.size.y / 2.0f});
+    HudText& title = m_hud.addText(*pFont, 30);
+    title.setString("IN A WORLD FULL OF TRASH\nWE MUST SURVIVE\nTHERE IS NO CHOICE\n\n\nW A S D TO MOVE\nMOUSE TO AIM \nLEFT CLICK TO SHOOT FIRE\nRIGHT CLICK TO SHOOT ICE\nDESTROY ENEMIES WITH THE CORRECT ELEMENT TO SCORE POINTS\n\nAND ALSO... TRY TO AVOID TRASH :)\n\n\nPRESS <ENTER> TO START");
+    title.setStyle(sf::Text::Bold);
+    title.setPlacement({0.5f, 0.5f}, {0.0f, 0.0f}, {0.5f, 0.5f});
 
-    // Create high score text
-    m_pHighScoreText = std::make_unique<sf::Text>(*pFont);
-    if (!m_pHighScoreText)
-        return false;
-
-    m_pHighScoreText->setString("HIGH SCORE: " + std::to_string(m_highScore));
+    m_pHighScoreText = &m_hud.addText(*pFont, 30);
     m_pHighScoreText->setStyle(sf::Text::Bold);
-    m_pHighScoreText->setCharacterSize(30);
+    m_pHighScoreText->setPlacement({0.0f, 0.0f}, {WindowWidth - 275.0f, 10.0f});
+
+    m_pLeaderboardText = &m_hud.addText(*pFont, 16);
+    m_pLeaderboardText->setPlacement({0.0f, 0.0f}, {WindowWidth - 275.0f, 50.0f});
 
+    refreshScores();
     return true;
 }
 
 void StateMenu::update(float dt)
 {
     (void)dt;
-    
-    // Reload high score every frame to ensure it's up-to-date
-    m_highScore = loadHighScore();
-    if (m_pHighScoreText)
-        m_pHighScoreText->setString("HIGH SCORE: " + std::to_string(m_highScore));
-    
-    m_hasStartKeyBeenPressed |= sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Enter);
-    if (m_hasStartKeyBeenReleased)
+
+    // The store is in memory; the texts are only rebuilt when a run changed it
+    if (m_scoreVersion != ScoreStore::getVersion())
+        refreshScores();
+
+    const InputSnapshot& input = Input::getSnapshot();
+    m_hasStartKeyBeenPressed |= input.wasPressed(INPUT_ACTION_CONFIRM);
+    if (m_hasStartKeyBeenReleased && ResourceManager::isIdle())
     {
         m_hasStartKeyBeenPressed = false;
         m_hasStartKeyBeenReleased = false;
         m_stateStack.push<StatePlaying>();
     }
-    m_hasStartKeyBeenReleased |= m_hasStartKeyBeenPressed && !sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Enter);
+    m_hasStartKeyBeenReleased |= m_hasStartKeyBeenPressed && !input.isDown(INPUT_ACTION_CONFIRM);
 }
 
 void StateMenu::render(sf::RenderTarget& target) const
 {
-    m_pText->setPosition({target.getSize().x * 0.5f, target.getSize().y * 0.5f});
-    target.draw(*m_pText);
-    
-    m_pHighScoreText->setPosition({WindowWidth - 275.0f, 10.0f});
-    target.draw(*m_pHighScoreText);
+    m_hud.render(target);
 }
 
-unsigned int StateMenu::loadHighScore()
+void StateMenu::refreshScores()
 {
-    std::ifstream file("highscore.txt");
-    if (file.is_open())
-    {
-        unsigned int score = 0;
-        file >> score;
-        file.close();
-        return score;
-    }
-    return 0;
-}
+    m_scoreVersion = ScoreStore::getVersion();
+    m_pHighScoreText->setNumber("HIGH SCORE: ", ScoreStore::getHighScore());
 
-void StateMenu::saveHighScore(unsigned int score)
-{
-    unsigned int currentHighScore = loadHighScore();
-    if (score > currentHighScore)
+    std::string board;
+    const std::vector<ScoreEntry>& entries = ScoreStore::getEntries();
+    for (size_t i = 0; i < std::min(entries.size(), LeaderboardRows); ++i)
     {
-        std::ofstream file("highscore.txt");
-        if (file.is_open())
-        {
-            file << score;
-            file.close();
-        }
+        const ScoreEntry& entry = entries[i];
+        unsigned int seconds = static_cast<unsigned int>(entry.durationSeconds);
+        char line[64];
+        std::snprintf(line, sizeof(line), "%zu. %6u  %2u:%02u  STAGE %u\n", i + 1, entry.score,
+                      seconds / 60, seconds % 60, entry.difficultyStage);
+        board += line;
     }
+    m_pLeaderboardText->setString(board);
 }
@@ -1,9 +1,8 @@
 #pragma once
 
 #include "IState.h"
-#include <memory>
-
-namespace sf { class Text; };
+#include "ui/Hud.h"
+#include <cstdint>
 
 class StateMenu : public IState
 {
@@ -15,14 +14,14 @@ public:
     void update(float dt) override;
     void render(sf::RenderTarget& target) const override;
 
-    static unsigned int loadHighScore();
-    static void saveHighScore(unsigned int score);
-
 public:
     StateStack& m_stateStack;
-    std::unique_ptr<sf::Text> m_pText;
-    std::unique_ptr<sf::Text> m_pHighScoreText;
+    mutable Hud m_hud;
+    HudText* m_pHighScoreText = nullptr;
+    HudText* m_pLeaderboardText = nullptr;
     bool m_hasStartKeyBeenPressed = false;
     bool m_hasStartKeyBeenReleased = false;
-    unsigned int m_highScore = 0;
+    uint32_t m_scoreVersion = 0;    // ScoreStore version the texts were built from
+
+    void refreshScores();
 };
@@ -1,9 +1,9 @@
 #include "StatePaused.h"
 #include "StateStack.h"
 #include "ResourceManager.h"
+#include "core/Input.h"
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Font.hpp>
-#include <SFML/Graphics/Text.hpp>
 
 StatePaused::StatePaused(StateStack& stateStack)
     : m_stateStack(stateStack)
@@ -13,20 +13,14 @@ StatePaused::StatePaused(StateStack& stateStack)
 
 bool StatePaused::init()
 {
-    m_pPrevState = m_stateStack.getCurrentState();
-
     const sf::Font* pFont = ResourceManager::getOrLoadFont("Lavigne.ttf");
     if (pFont == nullptr)
         return false;
 
-    m_pText = std::make_unique<sf::Text>(*pFont);
-    if (!m_pText)
-        return false;
-
-    m_pText->setString("PRESS <ESC> TO UNPAUSE");
-    m_pText->setStyle(sf::Text::Bold);
-    sf::FloatRect localBounds = m_pText->getLocalBounds();
-    m_pText->setOrigin({localBounds.size.x / 2.0f, localBounds.size.y / 2.0f});
+    HudText& text = m_hud.addText(*pFont, 30);
+    text.setString("PRESS <ESC> TO UNPAUSE");
+    text.setStyle(sf::Text::Bold);
+    text.setPlacement({0.5f, 0.2f}, {0.0f, 0.0f}, {0.5f, 0.5f});
 
     return true;
 }
@@ -34,17 +28,14 @@ bool StatePaused::init()
 void StatePaused::update(float dt)
 {
     (void)dt;
-    bool isPauseKeyPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Escape);
-    m_hasPauseKeyBeenReleased |= !isPauseKeyPressed;
-    if (m_hasPauseKeyBeenReleased && isPauseKeyPressed)
+    // The press that paused was consumed on an earlier frame, so only a new one unpauses
+    if (Input::getSnapshot().wasPressed(INPUT_ACTION_PAUSE))
         m_stateStack.popDeferred();
 }
 
 void StatePaused::render(sf::RenderTarget& target) const
 {
-    if (m_pPrevState != nullptr)
-        m_pPrevState->render(target);
-
-    m_pText->setPosition({target.getSize().x * 0.5f, target.getSize().y * 0.2f});
-    target.draw(*m_pText);
+    // The game underneath is frozen, so it comes from the stack's cached frame
+    m_stateStack.renderBelow(this, target);
+    m_hud.render(target);
 }
@@ -1,9 +1,7 @@
 #pragma once
 
 #include "IState.h"
-#include <memory>
-
-namespace sf { class Text; };
+#include "ui/Hud.h"
 
 class StatePaused : public IState
 {
@@ -17,7 +15,5 @@ public:
 
 public:
     StateStack& m_stateStack;
-    const IState* m_pPrevState = nullptr;
-    std::unique_ptr<sf::Text> m_pText;
-    bool m_hasPauseKeyBeenReleased = false;
+    mutable Hud m_hud;
 };
@@ -1,20 +1,150 @@
 #include "StatePlaying.h"
 #include "StatePaused.h"
-#include "StateMenu.h"
 #include "StateStack.h"
 #include "ResourceManager.h"
+#include "ScoreStore.h"
+#include "core/FrameArena.h"
+#include "core/FrameGovernor.h"
+#include "core/Input.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+#include "core/Telemetry.h"
 #include <memory>
 #include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <type_traits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include "../particles/ParticleWorld.h"
 #include "../particles/Particle.h"
+#include "../particles/Reactions.h"
 #include "../Constants.h"
 
+namespace
+{
+    const char* const MaterialCounterNames[MAT_ID_COUNT] = {
+        "cells_empty", "cells_sand", "cells_water", "cells_wood", "cells_stone",
+        "cells_oil", "cells_fire", "cells_woodfire", "cells_smoke"
+    };
+
+    // Caps on live counts. Difficulty keeps raising spawn rates, so these are what
+    // keep long runs bounded; the soft caps sit where frame cost starts to climb.
+    const SpawnCap EnemyCap = {40, 64};
+    const SpawnCap ProjectileCap = {192, 256};
+    struct MaterialCap
+    {
+        int mat_id;
+        const char* name;
+        SpawnCap cap;
+    };
+    const MaterialCap MaterialCaps[] = {
+        {MAT_ID_SAND, "sand", {6000, 9000}},
+        {MAT_ID_WATER, "water", {4000, 6000}},
+        {MAT_ID_WOOD, "wood", {5000, 8000}},
+    };
+
+    // Projectiles per collision query job
+    const size_t CollisionSliceSize = 64;
+
+    // A projectile hitting sand or water throws the cells around the hit forward
+    const float ProjectileSplashRadius = 10.0f;
+    const float ProjectileSplashSpeedFactor = 0.4f;
+
+    ParticleWorldSettings settingsForQuality(QualityLevel level)
+    {
+        ParticleWorldSettings settings;
+        settings.fireFlicker = level < QUALITY_LEVEL_REDUCED_EFFECTS;
+        if (level >= QUALITY_LEVEL_REDUCED_SIMULATION)
+        {
+            settings.maxDispersity = 2;
+            settings.singleReactionRoll = true;
+        }
+        return settings;
+    }
+}
+
+StatePlaying::PlayingResources::PlayingResources()
+    : enemyGrid({-CollisionWorldMargin, -CollisionWorldMargin},
+                {WindowWidth + CollisionWorldMargin, WindowHeight + CollisionWorldMargin},
+                CollisionCellSize)
+{
+}
+
+bool StatePlaying::PlayingResources::init()
+{
+    pParticleWorld = std::make_unique<ParticleWorld>();
+    if (!pParticleWorld)
+        return false;
+
+    if (!entities.init())
+        return false;
+
+    // Stream at the top right corner, alternating sand (2-4s) and water (0.2-1s)
+    EmitterDesc stream;
+    stream.rate = StreamEmitterRate;
+    stream.shape = EMITTER_SHAPE_POINTS;
+    stream.areaMin = {WindowWidth - 50.0f, 10.0f};
+    stream.areaMax = {WindowWidth - 10.0f, 10.0f};
+    stream.schedule = {{MAT_ID_SAND, 2.0f, 4.0f}, {MAT_ID_WATER, 0.2f, 1.0f}};
+    stream.budgetPerFrame = 8;
+    streamEmitter = emitters.addEmitter(stream);
+
+    // Wood blobs anywhere on screen away from the edges; the rate is set per run
+    float margin = 75.0f;
+    EmitterDesc wood;
+    wood.shape = EMITTER_SHAPE_BLOB;
+    wood.areaMin = {margin, margin};
+    wood.areaMax = {WindowWidth - margin, WindowHeight - margin};
+    wood.minRadius = 20.0f;
+    wood.maxRadius = 40.0f;
+    wood.density = WoodBlobDensity;
+    wood.schedule = {{MAT_ID_WOOD, 1.0f, 1.0f}};
+    wood.budgetPerFrame = 1;
+    woodEmitter = emitters.addEmitter(wood);
+
+    enemyPool = spawnBudget.addPool("enemy", EnemyCap);
+    projectilePool = spawnBudget.addPool("projectile", ProjectileCap);
+
+    size_t materialPools[MAT_ID_COUNT];
+    std::fill(materialPools, materialPools + MAT_ID_COUNT, SIZE_MAX);
+    for (const MaterialCap& material : MaterialCaps)
+        materialPools[material.mat_id] = spawnBudget.addPool(material.name, material.cap);
+    emitters.setSpawnBudget(&spawnBudget, materialPools);
+
+    pPlayer = std::make_unique<Player>();
+    if (!pPlayer || !pPlayer->init())
+        return false;
+    pPlayer->setParticleWorld(pParticleWorld.get());
+
+    rewind.init(RewindSettings(), REWIND_PLANE_COUNT);
+
+    isInitialized = true;
+    return true;
+}
+
+void StatePlaying::PlayingResources::reset()
+{
+    pParticleWorld->reset();
+    pPlayer->reset();
+    entities.clear();
+    emitters.reset();
+    spawnBudget.reset();
+    rewind.reset();
+}
+
 StatePlaying::StatePlaying(StateStack& stateStack)
     : m_stateStack(stateStack)
+    , m_pResources(s_pPooledResources ? std::move(s_pPooledResources) : std::make_unique<PlayingResources>())
+    , m_entities(m_pResources->entities)
+    , m_emitters(m_pResources->emitters)
+    , m_spawnBudget(m_pResources->spawnBudget)
+    , m_enemyGrid(m_pResources->enemyGrid)
+    , m_snapshots(m_pResources->snapshots)
 {
+    buildStepGraph();
 }
 
 bool StatePlaying::init()
@@ -23,29 +153,199 @@ bool StatePlaying::init()
     m_ground.setPosition({0.0f, 800.0f});
     m_ground.setFillColor(sf::Color::Green);
 
-    m_pParticleWorld = std::make_unique<ParticleWorld>();
-    if (!m_pParticleWorld)
-        return false;
-
-    m_pPlayer = std::make_unique<Player>();
-    if (!m_pPlayer || !m_pPlayer->init())
+    // The pool only ever holds fully built sets, so a pooled one just needs clearing
+    if (m_pResources->isInitialized)
+        m_pResources->reset();
+    else if (!m_pResources->init())
         return false;
+    m_pParticleWorld = m_pResources->pParticleWorld.get();
+    m_pPlayer = m_pResources->pPlayer.get();
     m_pPlayer->setPosition(sf::Vector2f(200, GroundLevel));
-    m_pPlayer->setParticleWorld(m_pParticleWorld.get());
-    m_pPlayer->setParticleWorldPointer(m_pParticleWorld.get());
 
-    m_font = ResourceManager::getOrLoadFont("Lavigne.ttf");
-    if (!m_font)
+    // Each run seeds its generators from the session seed and how many runs came
+    // before it, so a replay of the session lands on the same numbers run for run
+    uint32_t runSeed = Input::getSeed() + s_runCount++ * Random::DefaultSeed;
+    m_pParticleWorld->setSeed(runSeed);
+    m_emitters.setSeed(runSeed + 1);
+    m_emitters.reset();
+    m_spawnRandom.setSeed(runSeed + 2);
+
+    // Difficulty changes the wood rate during a run, so every run starts it over
+    m_emitters.setRate(m_pResources->woodEmitter, 1.0f / m_woodSpawnInterval);
+    initTelemetry();
+
+    const sf::Font* pFont = ResourceManager::getOrLoadFont("Lavigne.ttf");
+    if (!pFont)
         return false;
 
+    m_pScoreText = &m_hud.addText(*pFont, 30);
+    m_pScoreText->setColor(sf::Color::White);
+    m_pScoreText->setPlacement({0.0f, 0.0f}, {10.f, 10.f});
+
     m_score = 0;
+    buildSnapshot(m_snapshots[m_frontSnapshot]);
     return true;
 }
 
+StatePlaying::~StatePlaying()
+{
+    // The step may still be running against members that are about to go
+    m_simulationThread.stop();
+
+    // Only a fully built set is worth keeping for the next run
+    if (m_pResources->isInitialized)
+        s_pPooledResources = std::move(m_pResources);
+}
+
+void StatePlaying::initTelemetry()
+{
+    m_counters.cellsVisited = Telemetry::addCounter("cells_visited");
+    m_counters.swaps = Telemetry::addCounter("swaps");
+    m_counters.burningCells = Telemetry::addCounter("burning_cells");
+    m_counters.awakeChunks = Telemetry::addCounter("awake_chunks");
+    m_counters.freeParticles = Telemetry::addCounter("free_particles");
+    m_counters.reactions = Telemetry::addCounter("reactions");
+    m_counters.waterBodies = Telemetry::addCounter("water_bodies");
+    m_counters.skippedWater = Telemetry::addCounter("skipped_water");
+    for (int mat_id = MAT_ID_SAND; mat_id < MAT_ID_COUNT; ++mat_id)
+        m_counters.cellsPerMaterial[mat_id] = Telemetry::addCounter(MaterialCounterNames[mat_id]);
+    m_counters.projectiles = Telemetry::addCounter("projectiles");
+    m_counters.enemies = Telemetry::addCounter("enemies");
+    m_counters.collisionPairsTested = Telemetry::addCounter("collision_pairs_tested");
+    m_counters.rewindBytes = Telemetry::addCounter("rewind_bytes");
+}
+
+void StatePlaying::sampleTelemetry()
+{
+    if (m_pParticleWorld)
+    {
+        const ParticleWorldStats& stats = m_pParticleWorld->getStats();
+        Telemetry::set(m_counters.cellsVisited, stats.cellsVisited);
+        Telemetry::set(m_counters.swaps, stats.swaps);
+        Telemetry::set(m_counters.burningCells, stats.burningCells);
+        Telemetry::set(m_counters.awakeChunks, stats.awakeChunks);
+        Telemetry::set(m_counters.freeParticles, stats.freeParticles);
+        Telemetry::set(m_counters.reactions, stats.reactions);
+        Telemetry::set(m_counters.waterBodies, stats.waterBodies);
+        Telemetry::set(m_counters.skippedWater, stats.skippedWater);
+        for (int mat_id = MAT_ID_SAND; mat_id < MAT_ID_COUNT; ++mat_id)
+            Telemetry::set(m_counters.cellsPerMaterial[mat_id], stats.cellsPerMaterial[mat_id]);
+    }
+    Telemetry::set(m_counters.projectiles, m_entities.getProjectiles().size());
+    Telemetry::set(m_counters.enemies, m_entities.getEnemies().size());
+    Telemetry::set(m_counters.collisionPairsTested, m_collisionPairsTested);
+    Telemetry::set(m_counters.rewindBytes, m_pResources->rewind.getMemoryUsed());
+}
+
 void StatePlaying::update(float dt)
 {
+    // Collect the step that ran alongside the last render before anything reads the world
+    finishStep();
+    if (m_isGameOver)
+        return;
+
+    // Pause game
+    const InputSnapshot& input = Input::getSnapshot();
+    if (input.wasPressed(INPUT_ACTION_PAUSE))
+    {
+        // Nothing more this frame, or the run would move a step on behind the pause screen
+        m_stateStack.push<StatePaused>();
+        return;
+    }
+
+    // Holding R plays recorded history backwards instead of stepping
+    if (updateRewind(input.isDown(INPUT_ACTION_REWIND)))
+        return;
+
+    // Everything the step reads from outside the simulation is captured here
+    m_stepInput.dt = dt;
+    m_stepInput.player = Player::readInput(input, m_aimPosition);
+    m_stepInput.quality = FrameGovernor::getLevel();
+    m_stepInput.isStrictAllocations = AllocationTracker::isStrict();
+    m_stepOutput.workerAllocations = AllocationFrameCounts();
+    m_isStepInFlight = true;
+
+    if (s_pipelined)
+    {
+        if (!m_simulationThread.isStarted())
+            m_simulationThread.start([this]() { stepOnWorker(); });
+        m_simulationThread.kick();
+    }
+    else
+    {
+        step();
+        finishStep();
+    }
+}
+
+void StatePlaying::finishStep()
+{
+    if (!m_isStepInFlight)
+        return;
+
+    {
+        PROFILE_SCOPE("StatePlaying::waitForStep");
+        if (m_simulationThread.isStarted())
+            m_simulationThread.wait();
+    }
+    m_isStepInFlight = false;
+    m_frontSnapshot = 1 - m_frontSnapshot;
+    AllocationTracker::addToThread(m_stepOutput.workerAllocations);
+
+    // Telemetry is not thread-safe, so counters are published here rather than by the step
+    m_spawnBudget.publishTelemetry();
+    sampleTelemetry();
+
+    // End Playing State on player death
+    if (m_stepOutput.playerDied)
+    {
+        ScoreEntry entry;
+        entry.score = m_score;
+        entry.durationSeconds = m_gameTime;
+        entry.difficultyStage = m_difficultyStage;
+        entry.timestamp = static_cast<int64_t>(std::time(nullptr));
+        ScoreStore::submit(entry);
+        m_stateStack.popDeferred();
+        m_isGameOver = true;
+    }
+}
+
+void StatePlaying::stepOnWorker()
+{
+    // The allocation tracker's strict mode and frame counts are per thread, so the step
+    // follows the main thread's mode and reports what it allocated for finishStep() to add
+    AllocationTracker::setStrict(m_stepInput.isStrictAllocations);
+    AllocationFrameCounts start = AllocationTracker::getThreadCounts();
+
+    step();
+    // The worker's arena is reset after every step, like the main one after every frame
+    FrameArena::reset();
+
+    AllocationFrameCounts end = AllocationTracker::getThreadCounts();
+    m_stepOutput.workerAllocations.allocations = end.allocations - start.allocations;
+    m_stepOutput.workerAllocations.bytes = end.bytes - start.bytes;
+    m_stepOutput.workerAllocations.strictViolations = end.strictViolations - start.strictViolations;
+}
+
+void StatePlaying::buildSnapshot(PlayingSnapshot& snapshot) const
+{
+    PROFILE_SCOPE("StatePlaying::buildSnapshot");
+    if (m_pParticleWorld)
+        m_pParticleWorld->buildVertices(snapshot.particleVertices);
+    m_entities.buildRenderBatch(snapshot.entities);
+    if (m_pPlayer)
+        snapshot.playerPosition = m_pPlayer->getPosition();
+    snapshot.score = m_score;
+}
+
+void StatePlaying::step()
+{
+    PROFILE_SCOPE("StatePlaying::step");
+    const float dt = m_stepInput.dt;
+
     // Track total game time
     m_gameTime += dt;
+    m_spawnBudget.beginStep();
     
     // Difficulty scaling
     m_difficultyTimer += dt;
@@ -54,22 +354,14 @@ void StatePlaying::update(float dt)
         m_difficultyTimer = 0.0f;
         enemySpawnInterval = std::max(0.1f, enemySpawnInterval - 0.1f);
         m_woodSpawnInterval = std::max(0.5f, m_woodSpawnInterval - 0.1f); // Wood spawns faster too
+        m_emitters.setRate(m_pResources->woodEmitter, 1.0f / m_woodSpawnInterval);
         m_difficultyStage += 1;
         if (m_difficultyStage % 5 == 0)
             m_enemySpawnCount += 1;
     }
 
-    // Pause game
-    bool isPauseKeyPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Escape);
-    m_hasPauseKeyBeenReleased |= !isPauseKeyPressed;
-    if (m_hasPauseKeyBeenReleased && isPauseKeyPressed)
-    {
-        m_hasPauseKeyBeenReleased = false;
-        m_stateStack.push<StatePaused>();
-    }
-
     if (m_pPlayer)
-        m_pPlayer->update(dt);
+        m_pPlayer->update(dt, m_stepInput.player);
     
     // Pass game time to player for particle push scaling
     if (m_pPlayer)
@@ -79,309 +371,360 @@ void StatePlaying::update(float dt)
     if (m_pPlayer && m_pPlayer->hasProjectileRequest())
     {
         auto request = m_pPlayer->getProjectileRequest();
-        m_projectiles.push_back(std::make_unique<Projectile>(
-            request.position, 
-            request.velocity, 
-            request.projectileType
-        ));
+        uint32_t live = static_cast<uint32_t>(m_entities.getProjectiles().size());
+        if (m_spawnBudget.request(m_pResources->projectilePool, live, 1) > 0)
+            m_entities.spawnProjectile(request.position, request.velocity, request.projectileType);
         m_pPlayer->clearProjectileRequest();
     }
-
-    // Update projectiles
-    for (auto& projectile : m_projectiles)
-        projectile->update(dt);
-
-    // Remove off-screen projectiles
-    for (int i = m_projectiles.size() - 1; i >= 0; --i)
+    if (m_pPlayer && m_pPlayer->hasSplashRequest())
     {
-        if (m_projectiles[i]->isOffScreen())
-            m_projectiles.erase(m_projectiles.begin() + i);
+        const Player::SplashRequest& splash = m_pPlayer->getSplashRequest();
+        if (m_pParticleWorld)
+            m_pParticleWorld->applyImpulse(splash.position, splash.radius, splash.velocity);
+        m_pPlayer->clearSplashRequest();
     }
 
-    // Handle fire projectile-wood particle collisions
+    // Move projectiles and drop the ones that left the screen
+    m_entities.updateProjectiles(dt);
+
+    // Handle projectile-particle collisions: wood reacts with the projectile through the
+    // reaction table, and sand and water are splashed out of the grid
     if (m_pParticleWorld)
     {
-        for (int i = m_projectiles.size() - 1; i >= 0; --i)
+        PROFILE_SCOPE("StatePlaying::projectileParticles");
+        ProjectileArchetype& projectiles = m_entities.getProjectiles();
+        uint8_t* projectileRemoved = FrameArena::allocateZeroed<uint8_t>(projectiles.size());
+        for (size_t i = 0; i < projectiles.size(); ++i)
         {
-            bool projectileErased = false;
-            
-            if (m_projectiles[i]->getProjectileType() == PROJECTILE_TYPE_FIRE)
-            {
-                sf::Vector2f projPos = m_projectiles[i]->getPosition();
-                
-                int projGridX = static_cast<int>(projPos.x / ParticleScale);
-                int projGridY = static_cast<int>(projPos.y / ParticleScale);
-                
-                int checkRadius = 1;
-                for (int dx = -checkRadius; dx <= checkRadius && !projectileErased; ++dx)
-                {
-                    for (int dy = -checkRadius; dy <= checkRadius && !projectileErased; ++dy)
-                    {
-                        int gridX = projGridX + dx;
-                        int gridY = projGridY + dy;
-                        
-                        // Strict bounds checking
-                        if (gridX >= 0 && gridX < GRID_WIDTH && gridY >= 0 && gridY < GRID_HEIGHT)
-                        {
-                            Particle& particle = m_pParticleWorld->getParticleAt(gridX, gridY);
-                            if (particle.getId() == MAT_ID_WOOD)
-                            {
-                                // Calculate actual distance between projectile center and particle center
-                                float particleWorldX = (gridX * ParticleScale) + (ParticleScale / 2.0f);
-                                float particleWorldY = (gridY * ParticleScale) + (ParticleScale / 2.0f);
-                                float dx_real = projPos.x - particleWorldX;
-                                float dy_real = projPos.y - particleWorldY;
-                                float distSq = dx_real * dx_real + dy_real * dy_real;
-                                
-                                // Projectile is 2x2, particle is 4x4, collision if centers are close
-                                // Use ParticleScale as the collision distance (one particle width)
-                                float maxDist = ParticleScale * 1.5f; // 6 pixels with ParticleScale=4
-                                if (distSq < maxDist * maxDist)
-                                {
-                                    particle.setIsOnFire(true);
-                                    
-                                    // Remove the projectile
-                                    m_projectiles.erase(m_projectiles.begin() + i);
-                                    projectileErased = true;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            // Handle water/ice projectile-wood particle collisions
-            else if (m_projectiles[i]->getProjectileType() == PROJECTILE_TYPE_WATER)
+            sf::Vector2f projPos = projectiles.positions[i];
+            int projectileType = projectiles.types[i];
+
+            int projGridX = static_cast<int>(projPos.x / ParticleScale);
+            int projGridY = static_cast<int>(projPos.y / ParticleScale);
+
+            int checkRadius = 1;
+            bool projectileHit = false;
+            for (int dx = -checkRadius; dx <= checkRadius && !projectileHit; ++dx)
             {
-                sf::Vector2f projPos = m_projectiles[i]->getPosition();
-                
-                int projGridX = static_cast<int>(projPos.x / ParticleScale);
-                int projGridY = static_cast<int>(projPos.y / ParticleScale);
-                
-                int checkRadius = 1;
-                for (int dx = -checkRadius; dx <= checkRadius && !projectileErased; ++dx)
+                for (int dy = -checkRadius; dy <= checkRadius && !projectileHit; ++dy)
                 {
-                    for (int dy = -checkRadius; dy <= checkRadius && !projectileErased; ++dy)
+                    int gridX = projGridX + dx;
+                    int gridY = projGridY + dy;
+
+                    // Strict bounds checking
+                    if (gridX < 0 || gridX >= GRID_WIDTH || gridY < 0 || gridY >= GRID_HEIGHT)
+                        continue;
+
+                    Particle& particle = m_pParticleWorld->getParticleAt(gridX, gridY);
+                    int matId = particle.getId();
+                    if (matId != MAT_ID_WOOD && matId != MAT_ID_SAND && matId != MAT_ID_WATER)
+                        continue;
+
+                    // Calculate actual distance between projectile center and particle center
+                    float particleWorldX = (gridX * ParticleScale) + (ParticleScale / 2.0f);
+                    float particleWorldY = (gridY * ParticleScale) + (ParticleScale / 2.0f);
+                    float dx_real = projPos.x - particleWorldX;
+                    float dy_real = projPos.y - particleWorldY;
+                    float distSq = dx_real * dx_real + dy_real * dy_real;
+
+                    // Use ParticleScale as the collision distance (one particle width)
+                    float maxDist = ParticleScale * 1.5f; // 6 pixels with ParticleScale=4
+                    if (distSq < maxDist * maxDist)
                     {
-                        int gridX = projGridX + dx;
-                        int gridY = projGridY + dy;
-                        
-                        // Strict bounds checking
-                        if (gridX >= 0 && gridX < GRID_WIDTH && gridY >= 0 && gridY < GRID_HEIGHT)
-                        {
-                            Particle& particle = m_pParticleWorld->getParticleAt(gridX, gridY);
-                            if (particle.getId() == MAT_ID_WOOD)
-                            {
-                                float particleWorldX = (gridX * ParticleScale) + (ParticleScale / 2.0f);
-                                float particleWorldY = (gridY * ParticleScale) + (ParticleScale / 2.0f);
-                                float dx_real = projPos.x - particleWorldX;
-                                float dy_real = projPos.y - particleWorldY;
-                                float distSq = dx_real * dx_real + dy_real * dy_real;
-                                
-                                float maxDist = ParticleScale * 1.5f;
-                                if (distSq < maxDist * maxDist)
-                                {
-                                    particle.setId(MAT_ID_EMPTY);
-                                    
-                                    m_projectiles.erase(m_projectiles.begin() + i);
-                                    projectileErased = true;
-                                }
-                            }
-                        }
+                        if (matId != MAT_ID_WOOD)
+                            m_pParticleWorld->applyImpulse(projPos, ProjectileSplashRadius,
+                                                           projectiles.velocities[i] * ProjectileSplashSpeedFactor);
+                        else
+                            m_pParticleWorld->applyReagent(gridX, gridY, projectileType == PROJECTILE_TYPE_FIRE
+                                                           ? REAGENT_FIRE_PROJECTILE : REAGENT_ICE_PROJECTILE);
+                        projectileHit = true;
                     }
                 }
             }
+            projectileRemoved[i] = projectileHit;
         }
+        m_entities.despawnProjectiles(projectileRemoved);
     }
 
-    if (m_pParticleWorld)
-        m_pParticleWorld->update(dt);
+    // Particles, enemies, collisions, then rewind and the snapshot; see buildStepGraph()
+    m_stepGraph.run();
+}
 
-    for (const std::unique_ptr<Enemy>& pEnemy : m_enemies)
-        pEnemy->update(dt);
+void StatePlaying::buildStepGraph()
+{
+    TaskGraph::TaskId particles = m_stepGraph.addTask("StatePlaying::stepParticles", [this]() { stepParticles(m_stepInput.dt); });
+    TaskGraph::TaskId enemies = m_stepGraph.addTask("StatePlaying::stepEnemies", [this]() { stepEnemies(m_stepInput.dt); });
+    TaskGraph::TaskId collisions = m_stepGraph.addTask("StatePlaying::stepCollisions", [this]()
+    {
+        // Check for bullet-enemy and player-enemy collisions
+        bool playerDied = updateCollisions();
+
+        // Check if player was pushed off the left edge
+        if (m_pPlayer && m_pPlayer->isPushedOffEdge())
+            playerDied = true;
+
+        // The state stack is only touched from the main thread, in finishStep()
+        m_stepOutput.playerDied = playerDied;
+    });
+    TaskGraph::TaskId rewind = m_stepGraph.addTask("StatePlaying::stepRewind", [this]() { recordRewindFrame(m_stepInput.dt); });
+    TaskGraph::TaskId snapshot = m_stepGraph.addTask("StatePlaying::stepSnapshot", [this]()
+    {
+        buildSnapshot(m_snapshots[1 - m_frontSnapshot]);
+    });
+
+    // Enemies spawned this step already take part in its collisions
+    m_stepGraph.addDependency(enemies, collisions);
+    for (TaskGraph::TaskId branch : {particles, collisions})
+    {
+        m_stepGraph.addDependency(branch, rewind);
+        m_stepGraph.addDependency(branch, snapshot);
+    }
+}
+
+void StatePlaying::stepParticles(float dt)
+{
+    if (!m_pParticleWorld)
+        return;
+    updateParticleWorld(dt);
+
+    // Particle emitters: the sand/water stream and the wood blobs
+    m_emitters.update(dt, *m_pParticleWorld);
+}
+
+void StatePlaying::stepEnemies(float dt)
+{
+    // Age enemies and drop expired ones
+    m_entities.updateEnemies(dt);
 
     // Spawn enemies
     m_timeUntilEnemySpawn -= dt;
     if (m_timeUntilEnemySpawn <= 0.0f)
     {
-        m_timeUntilEnemySpawn = enemySpawnInterval;
-        for (unsigned int i = 0; i < m_enemySpawnCount; ++i)
+        // A wave the budget turns away entirely is retried shortly instead of
+        // waiting out a whole interval
+        uint32_t live = static_cast<uint32_t>(m_entities.getEnemies().size());
+        uint32_t granted = m_spawnBudget.request(m_pResources->enemyPool, live, m_enemySpawnCount);
+        m_timeUntilEnemySpawn = granted > 0 ? enemySpawnInterval : std::min(enemySpawnInterval, SpawnRetryInterval);
+        m_enemySpawnPositions.clear();
+        m_enemySpawnTypes.clear();
+        for (unsigned int i = 0; i < granted; ++i)
         {
-            auto pEnemy = std::make_unique<Enemy>();
-            if (pEnemy && pEnemy->init())
-            {
-                float randomX = static_cast<float>(rand() % static_cast<int>(WindowWidth));
-                float randomY = static_cast<float>(rand() % static_cast<int>(WindowHeight / 2));
-                pEnemy->setPosition(sf::Vector2f(randomX, randomY));
-                pEnemy->setSpeed(EnemySpeed);
-                m_enemies.push_back(std::move(pEnemy));
-            }
+            int enemyType = (m_spawnRandom.next() % 2 == 0) ? ENEMY_TYPE_WATER : ENEMY_TYPE_FIRE;
+            float randomX = static_cast<float>(m_spawnRandom.next() % static_cast<uint32_t>(WindowWidth));
+            float randomY = static_cast<float>(m_spawnRandom.next() % static_cast<uint32_t>(WindowHeight / 2));
+            m_enemySpawnPositions.push_back(sf::Vector2f(randomX, randomY));
+            m_enemySpawnTypes.push_back(enemyType);
         }
+        m_entities.spawnEnemies(m_enemySpawnPositions.data(), m_enemySpawnTypes.data(), m_enemySpawnPositions.size());
     }
+}
+
+void StatePlaying::recordRewindFrame(float dt)
+{
+    static_assert(std::is_trivially_copyable_v<Particle>, "Cells are recorded as raw bytes");
+
+    RewindRunState run = {};
+    run.playerPosition = m_pPlayer->getPosition();
+    run.score = m_score;
+    run.gameTime = m_gameTime;
+    run.difficultyTimer = m_difficultyTimer;
+    run.difficultyStage = m_difficultyStage;
+    run.enemySpawnCount = m_enemySpawnCount;
+    run.enemySpawnInterval = enemySpawnInterval;
+    run.timeUntilEnemySpawn = m_timeUntilEnemySpawn;
+    run.woodSpawnInterval = m_woodSpawnInterval;
+    run.spawnRandomState = m_spawnRandom.getState();
 
-    for (int i = m_enemies.size() - 1; i >= 0; --i)
+    std::vector<uint8_t>& entities = m_pResources->rewindEntities;
+    m_entities.saveState(entities);
+
+    RewindPlane planes[REWIND_PLANE_COUNT];
+    planes[REWIND_PLANE_CELLS] = {m_pParticleWorld->getCells(), m_pParticleWorld->getCellCount() * sizeof(Particle)};
+    planes[REWIND_PLANE_ENTITIES] = {entities.data(), entities.size()};
+    planes[REWIND_PLANE_RUN] = {&run, sizeof(run)};
+    m_pResources->rewind.record(dt, planes);
+}
+
+bool StatePlaying::restoreRewindFrame(uint64_t frame)
+{
+    RewindBuffer& rewind = m_pResources->rewind;
+    if (!rewind.seek(frame))
+        return false;
+
+    const std::vector<uint8_t>& cells = rewind.getPlane(REWIND_PLANE_CELLS);
+    const std::vector<uint8_t>& entities = rewind.getPlane(REWIND_PLANE_ENTITIES);
+    const std::vector<uint8_t>& runBytes = rewind.getPlane(REWIND_PLANE_RUN);
+    if (cells.size() != m_pParticleWorld->getCellCount() * sizeof(Particle) || runBytes.size() != sizeof(RewindRunState))
+        return false;
+
+    m_pParticleWorld->setCells(reinterpret_cast<const Particle*>(cells.data()));
+    m_entities.loadState(entities.data(), entities.size());
+
+    RewindRunState run;
+    std::memcpy(&run, runBytes.data(), sizeof(run));
+    m_score = run.score;
+    m_gameTime = run.gameTime;
+    m_difficultyTimer = run.difficultyTimer;
+    m_difficultyStage = run.difficultyStage;
+    m_enemySpawnCount = run.enemySpawnCount;
+    enemySpawnInterval = run.enemySpawnInterval;
+    m_timeUntilEnemySpawn = run.timeUntilEnemySpawn;
+    m_woodSpawnInterval = run.woodSpawnInterval;
+    m_spawnRandom.setSeed(run.spawnRandomState);
+    m_emitters.setRate(m_pResources->woodEmitter, 1.0f / m_woodSpawnInterval);
+
+    // Momentum and cooldowns are not recorded; the player resumes from rest
+    m_pPlayer->reset();
+    m_pPlayer->setPosition(run.playerPosition);
+    m_pPlayer->setGameTime(m_gameTime);
+    return true;
+}
+
+bool StatePlaying::updateRewind(bool isRewindKeyPressed)
+{
+    RewindBuffer& rewind = m_pResources->rewind;
+    if (!isRewindKeyPressed)
     {
-        if (m_enemies[i]->isExpired())
+        // Let go: history after the frame on screen is dropped and the run carries on from it
+        if (m_isRewinding)
         {
-            m_enemies.erase(m_enemies.begin() + i);
+            rewind.truncateAtCursor();
+            m_isRewinding = false;
         }
+        return false;
     }
 
-    // Check for bullet-enemy collisions
-    for (int i = m_projectiles.size() - 1; i >= 0; --i)
+    if (!m_isRewinding)
     {
-        for (int j = m_enemies.size() - 1; j >= 0; --j)
-        {
-            float distance = (m_projectiles[i]->getPosition() - m_enemies[j]->getPosition()).lengthSquared();
-            float minDistance = std::pow(ProjectileWidth / 2.0f + m_enemies[j]->getCollisionRadius(), 2.0f);
-
-            if (distance <= minDistance)
-            {
-                // Damage the enemy if type matches
-                if (m_enemies[j]->setHealth(m_pPlayer->getDamage(), m_projectiles[i]->getProjectileType()))
-                {
-                    m_enemies.erase(m_enemies.begin() + j);
-                    m_score += 10.0f;
-                }
-                
-                m_projectiles.erase(m_projectiles.begin() + i);
-                break;
-            }
-        }
+        if (rewind.isEmpty())
+            return false;
+        m_isRewinding = true;
+        m_rewindFrame = rewind.getLastFrame();
     }
-
-    // Check for player-enemy collisions
-    bool playerDied = false;
-    for (const std::unique_ptr<Enemy>& pEnemy : m_enemies)
+    else if (m_rewindFrame > rewind.getFirstFrame())
     {
-        float distance = (m_pPlayer->getPosition() - pEnemy->getPosition()).lengthSquared();
-        float minDistance = std::pow(Player::collisionRadius + pEnemy->getCollisionRadius(), 2.0f);
-
-        if (distance <= minDistance)
-        {
-            playerDied = true;
-            break;
-        }
+        m_rewindFrame--;
     }
 
-    // Check if player was pushed off the left edge
-    if (m_pPlayer && m_pPlayer->isPushedOffEdge())
-        playerDied = true;
+    // No step is in flight here, so the shown snapshot can be rebuilt in place
+    if (restoreRewindFrame(m_rewindFrame))
+        buildSnapshot(m_snapshots[m_frontSnapshot]);
+    return true;
+}
 
-    // End Playing State on player death
-    if (playerDied)
-    {
-        StateMenu::saveHighScore(m_score);
-        m_stateStack.popDeferred();
-    }
+void StatePlaying::updateParticleWorld(float dt)
+{
+    QualityLevel level = m_stepInput.quality;
+    m_pParticleWorld->setSettings(settingsForQuality(level));
 
-    // Particle spawner - alternates between material types
-    static float particleSpawnTimer = 0.0f;
-    static float materialSwitchTimer = 0.0f;
-    static float materialSwitchDuration = 1.0f; // Initial duration
-    static int currentMaterialType = MAT_ID_SAND;
-    
-    particleSpawnTimer += dt;
-    materialSwitchTimer += dt;
-    
-    if (materialSwitchTimer >= materialSwitchDuration)
+    // At half rate the world steps on every other frame with both frames' dt, so
+    // burn times and the leftward scroll keep pace while falling slows down
+    m_pendingParticleDt += dt;
+    m_particleFrame++;
+    if (level >= QUALITY_LEVEL_HALF_RATE && m_particleFrame % 2 != 0)
+        return;
+
+    m_pParticleWorld->update(m_pendingParticleDt);
+    m_pendingParticleDt = 0.0f;
+}
+
+bool StatePlaying::updateCollisions()
+{
+    PROFILE_SCOPE("StatePlaying::updateCollisions");
+    EnemyArchetype& enemies = m_entities.getEnemies();
+    const ProjectileArchetype& projectiles = m_entities.getProjectiles();
+
+    // Broad phase: bin enemies into the grid once per step, straight from the component arrays
+    m_enemyGrid.build(enemies.positions.data(), enemies.radii.data(), enemies.size());
+
+    // Projectile queries only read the grid, so slices run in parallel and are joined in
+    // order; pair order, and with it which enemy a projectile is spent on, stays the same
+    size_t projectileCount = projectiles.size();
+    size_t sliceCount = (projectileCount + CollisionSliceSize - 1) / CollisionSliceSize;
+    if (m_collisionSlices.size() < sliceCount)
+        m_collisionSlices.resize(sliceCount);
+    JobSystem::parallelFor(static_cast<uint32_t>(sliceCount), 1, [&](uint32_t first, uint32_t last)
     {
-        materialSwitchTimer = 0.0f;
-        
-        currentMaterialType = (currentMaterialType == MAT_ID_SAND) ? MAT_ID_WATER : MAT_ID_SAND;
-        
-        if (currentMaterialType == MAT_ID_SAND)
+        for (uint32_t s = first; s < last; ++s)
         {
-            // Sand: 2.0 to 4.0 seconds
-            materialSwitchDuration = 2.0f + static_cast<float>(rand() % 201) / 100.0f;
-        }
-        else
-        {
-            // Water: 0.2 to 1 seconds
-            materialSwitchDuration = 0.2f + static_cast<float>(rand() % 81) / 100.0f;
+            size_t begin = s * CollisionSliceSize;
+            size_t count = std::min(CollisionSliceSize, projectileCount - begin);
+            CollisionSlice& slice = m_collisionSlices[s];
+            slice.pairs.clear();
+            slice.tested = m_enemyGrid.queryOverlaps(projectiles.positions.data() + begin,
+                                                     projectiles.radii.data() + begin, count, slice.pairs);
+            for (CollisionPair& pair : slice.pairs)
+                pair.queryIndex += static_cast<uint32_t>(begin);
         }
+    });
+
+    m_collisionPairs.clear();
+    m_collisionPairsTested = 0;
+    for (size_t s = 0; s < sliceCount; ++s)
+    {
+        const CollisionSlice& slice = m_collisionSlices[s];
+        m_collisionPairs.insert(m_collisionPairs.end(), slice.pairs.begin(), slice.pairs.end());
+        m_collisionPairsTested += slice.tested;
     }
-    
-    if (m_pParticleWorld && particleSpawnTimer > 0.001f)
+
+    // Resolve hits without erasing mid-iteration; a projectile is spent on the first enemy it touches
+    uint8_t* projectileRemoved = FrameArena::allocateZeroed<uint8_t>(projectiles.size());
+    uint8_t* enemyRemoved = FrameArena::allocateZeroed<uint8_t>(enemies.size());
+    for (const CollisionPair& pair : m_collisionPairs)
     {
-        particleSpawnTimer = 0.0f;
+        if (projectileRemoved[pair.queryIndex] || enemyRemoved[pair.itemIndex])
+            continue;
 
-        for (int i = 0; i < 1; ++i)
+        projectileRemoved[pair.queryIndex] = 1;
+        int projectileType = projectiles.types[pair.queryIndex];
+        if (enemies.applyDamage(pair.itemIndex, m_pPlayer->getDamage(), projectileType))
         {
-            float randomY = static_cast<float>(rand() % static_cast<int>(WindowHeight));
-            float randomX = WindowWidth - 10.0f - static_cast<float>(rand() % 40);
-            sf::Vector2f spawnPosition(randomX, 10);
-            sf::Vector2f velocity(0.0f, 0.0f);
-            
-            m_pParticleWorld->addParticle(spawnPosition, velocity, currentMaterialType);
+            enemyRemoved[pair.itemIndex] = 1;
+            m_score += 10.0f;
         }
     }
 
-    // Wood particle blob spawner
-    static float woodSpawnTimer = 0.0f;
-    woodSpawnTimer += dt;
-    
-    if (m_pParticleWorld && woodSpawnTimer > m_woodSpawnInterval)
+    // Player-enemy test runs against the same grid, ignoring enemies killed above
+    bool playerHit = false;
+    if (m_pPlayer)
     {
-        woodSpawnTimer = 0.0f;
-        
-        float margin = 75.0f;
-        float blobCenterX = margin + static_cast<float>(rand() % static_cast<int>(WindowWidth - 2 * margin));
-        float blobCenterY = margin + static_cast<float>(rand() % static_cast<int>(WindowHeight - 2 * margin));
-        
-        // Spawn a blob of wood particle and random radius
-        int blobSize = 240 + rand() % 181; 
-        float blobRadius = 20.0f + static_cast<float>(rand() % 21);
-        
-        for (int i = 0; i < blobSize; ++i)
+        sf::Vector2f playerPosition = m_pPlayer->getPosition();
+        float playerRadius = Player::collisionRadius;
+        m_collisionPairs.clear();
+        m_collisionPairsTested += m_enemyGrid.queryOverlaps(&playerPosition, &playerRadius, 1, m_collisionPairs);
+        for (const CollisionPair& pair : m_collisionPairs)
         {
-            // Random position within the blob radius
-            float angle = static_cast<float>(rand() % 360) * 3.14159f / 180.0f;
-            float distance = static_cast<float>(rand() % static_cast<int>(blobRadius));
-            
-            sf::Vector2f offset(
-                std::cos(angle) * distance,
-                std::sin(angle) * distance
-            );
-            
-            sf::Vector2f spawnPosition(blobCenterX + offset.x, blobCenterY + offset.y);
-            
-            // Clamp individual particles to safe area (at least 20 pixels from edges)
-            float finalX = std::max(margin, std::min(spawnPosition.x, WindowWidth - margin));
-            float finalY = std::max(margin, std::min(spawnPosition.y, WindowHeight - margin));
-            
-            m_pParticleWorld->addParticle(sf::Vector2f(finalX, finalY), sf::Vector2f(0.0f, 0.0f), MAT_ID_WOOD);
+            if (!enemyRemoved[pair.itemIndex])
+            {
+                playerHit = true;
+                break;
+            }
         }
     }
 
-}
+    m_entities.despawnProjectiles(projectileRemoved);
+    m_entities.despawnEnemies(enemyRemoved);
 
-void StatePlaying::renderScore(sf::RenderTarget& target) const
-{
-    if (!m_font)
-        return;
-    
-    sf::Text scoreText(*m_font);
-    scoreText.setString("Score: " + std::to_string(m_score));
-    scoreText.setFillColor(sf::Color::White);
-    scoreText.setPosition({10.f, 10.f});
-    target.draw(scoreText);
+    return playerHit;
 }
 
 void StatePlaying::render(sf::RenderTarget& target) const
 {
     // target.draw(m_ground);
 
-    for (const std::unique_ptr<Enemy>& pEnemy : m_enemies)
-        pEnemy->render(target);
-    
-    for (const std::unique_ptr<Projectile>& projectile : m_projectiles)
-        projectile->render(target);
+    // Only the render target knows the view, so the aim is mapped here and picked up by the next step
+    m_aimPosition = target.mapPixelToCoords(Input::getSnapshot().aimPixel);
+
+    // Draws the published snapshot only, so this may overlap the next step
+    const PlayingSnapshot& snapshot = m_snapshots[m_frontSnapshot];
+    m_entities.drawRenderBatch(target, snapshot.entities);
     
     if (m_pPlayer)
-        m_pPlayer->render(target);
+        m_pPlayer->render(target, snapshot.playerPosition);
     
-    if (m_pParticleWorld)
-        m_pParticleWorld->render(target);
+    target.draw(snapshot.particleVertices);
 
-    renderScore(target);
+    // The score text only reflows on the steps that changed it
+    m_pScoreText->setNumber("Score: ", snapshot.score);
+    m_hud.render(target);
 }
@@ -2,42 +2,206 @@
 
 #include "IState.h"
 #include "entities/Player.h"
-#include "entities/Enemy.h"
-#include "entities/Projectile.h"
+#include "entities/EntityStore.h"
+#include "collision/SpatialGrid.h"
+#include "particles/EmitterSystem.h"
+#include "core/AllocationTracker.h"
+#include "core/SpawnBudget.h"
+#include "core/FrameGovernor.h"
+#include "core/JobSystem.h"
+#include "core/Random.h"
+#include "core/RewindBuffer.h"
+#include "core/WorkerThread.h"
+#include "ui/Hud.h"
+#include <memory>
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
-#include <SFML/Graphics/Text.hpp>
 #include <SFML/Graphics/RectangleShape.hpp>
 
+// What render() draws: the look of one finished step, written by the step and
+// never touched again until the next one is collected
+struct PlayingSnapshot
+{
+    sf::VertexArray particleVertices;
+    EntityRenderBatch entities;
+    sf::Vector2f playerPosition;
+    unsigned int score = 0;
+};
+
+// update() samples input, hands it to a step and collects the previous step's
+// results. In pipelined mode the step runs on a worker while the main thread
+// renders the last published snapshot, so a frame costs about max(step, render)
+// instead of their sum, at the price of one frame of display latency.
 class StatePlaying : public IState
 {
 public:
     StatePlaying(StateStack& stateStack);
-    ~StatePlaying() = default;
+    ~StatePlaying();
 
     bool init() override;
     void update(float dt) override;
-	void renderScore(sf::RenderTarget &target) const;
 	void render(sf::RenderTarget &target) const override;
 
+    static void setPipelined(bool pipelined) { s_pipelined = pipelined; }
+    static bool isPipelined() { return s_pipelined; }
+    // Frees the pooled set; call once no state is left, before the systems it uses shut down
+    static void releasePool() { s_pPooledResources.reset(); }
+
 private:
+    struct StepInput
+    {
+        float dt = 0.0f;
+        PlayerInput player;
+        QualityLevel quality = QUALITY_LEVEL_FULL;
+        bool isStrictAllocations = false;   // The main thread's strict mode, for a step on the worker
+    };
+
+    struct StepOutput
+    {
+        bool playerDied = false;
+        AllocationFrameCounts workerAllocations;    // Made by a step on the worker; the main thread sees its own
+    };
+
+    // The expensive parts of a run. A finished run hands its set back to the pool
+    // and the next one clears it in place, so restarting from the menu allocates
+    // nothing and skips the texture lookups and emitter setup.
+    struct PlayingResources
+    {
+        std::unique_ptr<ParticleWorld> pParticleWorld;
+        std::unique_ptr<Player> pPlayer;
+        EntityStore entities;
+        EmitterSystem emitters;
+        SpawnBudget spawnBudget;
+        SpatialGrid enemyGrid;
+        PlayingSnapshot snapshots[2];
+        RewindBuffer rewind;
+        std::vector<uint8_t> rewindEntities;    // Flattened entity store, staged for the rewind buffer
+        size_t streamEmitter = 0;
+        size_t woodEmitter = 0;
+        size_t enemyPool = 0;
+        size_t projectilePool = 0;
+        bool isInitialized = false;
+
+        PlayingResources();
+        bool init();
+        void reset();
+    };
+
+    // Rewind planes: particle cells, flattened entities, then the run state below
+    enum RewindPlaneId
+    {
+        REWIND_PLANE_CELLS = 0,
+        REWIND_PLANE_ENTITIES = 1,
+        REWIND_PLANE_RUN = 2,
+        REWIND_PLANE_COUNT
+    };
+
+    // Everything outside the world and the entities that a rewound run needs back
+    struct RewindRunState
+    {
+        sf::Vector2f playerPosition;
+        unsigned int score;
+        float gameTime;
+        float difficultyTimer;
+        unsigned int difficultyStage;
+        unsigned int enemySpawnCount;
+        float enemySpawnInterval;
+        float timeUntilEnemySpawn;
+        float woodSpawnInterval;
+        uint32_t spawnRandomState;
+    };
+
+    static inline bool s_pipelined = true;
+    static inline std::unique_ptr<PlayingResources> s_pPooledResources;
+    static inline uint32_t s_runCount = 0;
+
     float enemySpawnInterval = EnemySpawnInterval;
     float m_timeUntilEnemySpawn = enemySpawnInterval;
     float m_woodSpawnInterval = 2.5f;
 
     StateStack& m_stateStack;
-    std::unique_ptr<Player> m_pPlayer;
-    std::unique_ptr<ParticleWorld> m_pParticleWorld;
-    std::vector<std::unique_ptr<Enemy>> m_enemies;
-    std::vector<std::unique_ptr<Projectile>> m_projectiles;
+    std::unique_ptr<PlayingResources> m_pResources;
+    Player* m_pPlayer = nullptr;
+    ParticleWorld* m_pParticleWorld = nullptr;
+    EntityStore& m_entities;
+    EmitterSystem& m_emitters;
+    SpawnBudget& m_spawnBudget;
+    SpatialGrid& m_enemyGrid;
     sf::RectangleShape m_ground;
-    const sf::Font* m_font = nullptr;
+    mutable Hud m_hud;
+    HudText* m_pScoreText = nullptr;
     unsigned int m_score = 0;
-    bool m_hasPauseKeyBeenReleased = true;
+    bool m_isRewinding = false;
+    uint64_t m_rewindFrame = 0;
     float m_difficultyTimer = 0.0f;
     float m_gameTime = 0.0f;
     unsigned int m_difficultyStage = 0; 
     unsigned int m_enemySpawnCount = EnemySpawnCount;
+    Random m_spawnRandom;   // Owned by the step, which may run on the simulation thread
+
+    // Particle time not yet simulated; builds up while the governor halves the update rate
+    float m_pendingParticleDt = 0.0f;
+    unsigned int m_particleFrame = 0;
+
+    // Spawn and collision scratch buffers, reused every step
+    std::vector<sf::Vector2f> m_enemySpawnPositions;
+    std::vector<int> m_enemySpawnTypes;
+    std::vector<CollisionPair> m_collisionPairs;
+    size_t m_collisionPairsTested = 0;
+
+    // Projectile queries run on the job pool in fixed slices, each into its own list
+    struct CollisionSlice
+    {
+        std::vector<CollisionPair> pairs;
+        size_t tested = 0;
+    };
+    std::vector<CollisionSlice> m_collisionSlices;
+
+    // The end of the step: the particle world and the enemies share nothing, so they
+    // run side by side, and rewind and the snapshot only read once both are done
+    TaskGraph m_stepGraph;
+
+    // Telemetry counter ids
+    struct Counters
+    {
+        size_t cellsVisited;
+        size_t swaps;
+        size_t burningCells;
+        size_t awakeChunks;
+        size_t freeParticles;
+        size_t reactions;
+        size_t waterBodies;
+        size_t skippedWater;
+        size_t cellsPerMaterial[MAT_ID_COUNT];
+        size_t projectiles;
+        size_t enemies;
+        size_t collisionPairsTested;
+        size_t rewindBytes;
+    } m_counters = {};
+
+    // Step handoff. The snapshot at m_frontSnapshot is the one being drawn; the
+    // step writes the other one and finishStep() flips them.
+    StepInput m_stepInput;
+    StepOutput m_stepOutput;
+    PlayingSnapshot* m_snapshots = nullptr;   // The two in m_pResources
+    int m_frontSnapshot = 0;
+    bool m_isStepInFlight = false;
+    bool m_isGameOver = false;
+    mutable sf::Vector2f m_aimPosition;
+    WorkerThread m_simulationThread;
 
-    void updateCollisions();
+    void step();
+    void finishStep();
+    void stepOnWorker();
+    void buildStepGraph();
+    void stepParticles(float dt);
+    void stepEnemies(float dt);
+    void buildSnapshot(PlayingSnapshot& snapshot) const;
+    void initTelemetry();
+    void sampleTelemetry();
+    void updateParticleWorld(float dt);
+    void recordRewindFrame(float dt);
+    bool restoreRewindFrame(uint64_t frame);
+    bool updateRewind(bool isRewindKeyPressed);
+    bool updateCollisions();
 };
@@ -0,0 +1,56 @@
+#include "StateStack.h"
+#include "core/Profiler.h"
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+StateStack::StateStack() = default;
+StateStack::~StateStack() = default;
+
+void StateStack::renderBelow(const IState* pOverlay, sf::RenderTarget& target)
+{
+    size_t index = 0;
+    while (index < m_states.size() && m_states[index].get() != pOverlay)
+        ++index;
+    if (index == 0 || index == m_states.size())
+        return;
+
+    // An overlay on an overlay: the lower one is being captured into the frame, so
+    // it draws its own background directly
+    const IState* pBelow = m_states[index - 1].get();
+    if (m_isCapturing)
+    {
+        pBelow->render(target);
+        return;
+    }
+
+    if (!m_pFrozenFrame)
+        m_pFrozenFrame = std::make_unique<sf::RenderTexture>();
+
+    sf::Vector2u size = target.getSize();
+    if (m_pFrozenState != pBelow || m_pFrozenFrame->getSize() != size)
+    {
+        PROFILE_SCOPE("StateStack::captureFrozenFrame");
+        if (m_pFrozenFrame->getSize() != size && !m_pFrozenFrame->resize(size))
+        {
+            LOG_WARN("Failed to create a {}x{} frozen frame, drawing the state below directly", size.x, size.y);
+            m_pFrozenState = nullptr;
+            pBelow->render(target);
+            return;
+        }
+
+        m_isCapturing = true;
+        m_pFrozenFrame->setView(target.getView());
+        m_pFrozenFrame->clear();
+        pBelow->render(*m_pFrozenFrame);
+        m_pFrozenFrame->display();
+        m_isCapturing = false;
+        m_pFrozenState = pBelow;
+    }
+
+    // The frame covers the target pixel for pixel, whatever view the target has
+    sf::View view = target.getView();
+    target.setView(target.getDefaultView());
+    target.draw(sf::Sprite(m_pFrozenFrame->getTexture()));
+    target.setView(view);
+}
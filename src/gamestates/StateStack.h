@@ -4,15 +4,21 @@
 #include <memory>
 #include <vector>
 #include <cassert>
-#include <iostream>
+#include <typeinfo>
+#include "core/Log.h"
+
+namespace sf { class RenderTarget; class RenderTexture; }
 
 class StateStack
 {
 public:
+    StateStack();
+    ~StateStack();
+
     template<typename T>
     bool push()
     {
-        std::cout << "Pushing state: " << typeid(T).name() << std::endl;
+        LOG_INFO("Pushing state: {}", typeid(T).name());
         std::unique_ptr<IState> pState = std::make_unique<T>(*this);
         bool ok = pState && pState->init();
         if (ok) m_states.push_back(std::move(pState));
@@ -23,11 +29,22 @@ public:
     {
         std::unique_ptr<IState> pState = std::move(m_states.back());
         m_states.pop_back();
+        m_pFrozenState = nullptr;
         return pState;
     }
 
     void popDeferred() { m_popDeferredCount++; }
 
+    // Destroys every state, top first. Call before shutting down the systems they
+    // use: a state may still have work running, e.g. a pipelined step.
+    void clear()
+    {
+        while (!m_states.empty())
+            m_states.pop_back();
+        m_pFrozenState = nullptr;
+        m_popDeferredCount = 0;
+    }
+
     IState* getCurrentState() { return m_states.empty() ? nullptr : m_states.back().get(); }
 
     void performDeferredPops()
@@ -38,11 +55,21 @@ public:
             if (m_states.empty())
                 break;
             m_states.pop_back();
+            m_pFrozenState = nullptr;
         }
         m_popDeferredCount = 0;
     }
 
+    // For overlays: draws the state below pOverlay. That state is not updating while
+    // covered, so it is rendered once into a cached frame and the frame is redrawn
+    // until the state is back on top. The first call after a pop captures afresh.
+    void renderBelow(const IState* pOverlay, sf::RenderTarget& target);
+
 private:
     std::vector<std::unique_ptr<IState>> m_states;
     size_t m_popDeferredCount = 0;
+
+    std::unique_ptr<sf::RenderTexture> m_pFrozenFrame;  // Kept across pauses so its storage is reused
+    const IState* m_pFrozenState = nullptr;             // State the frame shows; null when stale
+    bool m_isCapturing = false;
 };
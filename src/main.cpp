@@ -1,50 +1,212 @@
 #include "ResourceManager.h"
+#include "ScoreStore.h"
 #include "gamestates/StateStack.h"
 #include "gamestates/IState.h"
 #include "gamestates/StateMenu.h"
+#include "gamestates/StatePlaying.h"
 #include <memory>
 #include <stack>
+#include <cstring>
 #include <optional>
+#include <random>
 #include <SFML/Graphics.hpp>
 #include <SFML/System/Clock.hpp>
 #include <SFML/System/Time.hpp>
 #include "Constants.h"
+#include "core/AllocationTracker.h"
+#include "core/FrameArena.h"
+#include "core/FrameCapture.h"
+#include "core/FrameGovernor.h"
+#include "core/Input.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+#include "core/Profiler.h"
+#include "core/Telemetry.h"
+#include "ui/Hud.h"
+#include "ui/ProfilerOverlay.h"
 
 int main(int argc, char* argv[])
 {
-    (void)argc;
+    Log::init();
+    JobSystem::init();
 
     // ResourceManager must be instantiated here -- DO NOT CHANGE
     ResourceManager::init(argv[0]);
+    ScoreStore::init();
 
     sf::RenderWindow window(sf::VideoMode({WindowWidth, WindowHeight}), "Runner");
     // window.setKeyRepeatEnabled(false);
 
+    // Debug panels share one HUD layer drawn over whatever state is on top
+    Hud debugHud;
+    ProfilerOverlay profilerOverlay;
+    if (profilerOverlay.init())
+        debugHud.addOverlay(&profilerOverlay);
+    else
+        LOG_WARN("Profiler overlay unavailable");
+
+    FrameCapture frameCapture;
+
+    // --record <file> saves every frame's input, --replay <file> plays such a file back
+    // in place of the devices and closes the window when it runs out. A replay also
+    // brings back the seed of the session it was recorded from
+    Input::setSeed(std::random_device{}());
+    Input::setAimPixel(sf::Mouse::getPosition(window));
+    ReplayInputSource replaySource;
+    const char* recordPath = nullptr;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--record") == 0)
+            recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && replaySource.open(argv[++i]))
+        {
+            Input::setSource(&replaySource);
+            Input::setSeed(replaySource.getSeed());
+        }
+    }
+    // Started after any replay so the recording carries the seed actually in use
+    if (recordPath)
+        Input::setRecording(true, recordPath);
+
     StateStack gamestates;
     if (!gamestates.push<StateMenu>())
+    {
+        gamestates.clear();
+        StatePlaying::releasePool();
+        ResourceManager::shutdown();
+        ScoreStore::shutdown();
+        JobSystem::shutdown();
+        Log::shutdown();
         return -1;
+    }
 
+    size_t heapAllocationsCounter = Telemetry::addCounter("heap_allocations");
+    size_t heapBytesCounter = Telemetry::addCounter("heap_bytes");
+    FrameGovernor::init(FrameBudgetMs);
+
+    int forcedQualityLevel = QUALITY_LEVEL_COUNT;
     sf::Clock clock;
     while (window.isOpen())
     {
+        Profiler::beginFrame();
+        AllocationTracker::beginFrame();
         sf::Time elapsedTime = clock.restart();
+        int64_t frameStartNs = Profiler::nowNs();
 
         IState* pState = gamestates.getCurrentState();
-        if (!pState) return -1;
+        if (!pState)
+        {
+            gamestates.clear();
+            StatePlaying::releasePool();
+            frameCapture.stop();
+            ResourceManager::shutdown();
+            ScoreStore::shutdown();
+            JobSystem::shutdown();
+            Log::shutdown();
+            return -1;
+        }
 
         while (const std::optional event = window.pollEvent())
         {
+            Input::handleEvent(*event);
             if (event->is<sf::Event::Closed>())
-                window.close();;
+                window.close();
+            else if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>())
+            {
+                // F1 toggles the profiler overlay, F2 starts/stops a Chrome trace capture,
+                // F3 starts/stops telemetry recording, F4 toggles strict no-allocation frames,
+                // F5 pins the quality level, cycling through every level and back to automatic,
+                // F6 toggles running the simulation step on a worker alongside rendering,
+                // F7 starts/stops recording the window to a raw RGBA stream, F8 to a PNG sequence
+                if (keyPressed->code == sf::Keyboard::Key::F1)
+                    Profiler::setOverlayVisible(!Profiler::isOverlayVisible());
+                else if (keyPressed->code == sf::Keyboard::Key::F2)
+                {
+                    if (Profiler::isCapturing())
+                        Profiler::stopCapture("trace.json");
+                    else
+                        Profiler::startCapture();
+                }
+                else if (keyPressed->code == sf::Keyboard::Key::F3)
+                    Telemetry::setRecording(!Telemetry::isRecording());
+                else if (keyPressed->code == sf::Keyboard::Key::F4)
+                    AllocationTracker::setStrict(!AllocationTracker::isStrict());
+                else if (keyPressed->code == sf::Keyboard::Key::F5)
+                {
+                    forcedQualityLevel = (forcedQualityLevel + 1) % (QUALITY_LEVEL_COUNT + 1);
+                    FrameGovernor::setForcedLevel(static_cast<QualityLevel>(forcedQualityLevel));
+                }
+                else if (keyPressed->code == sf::Keyboard::Key::F6)
+                    StatePlaying::setPipelined(!StatePlaying::isPipelined());
+                else if (keyPressed->code == sf::Keyboard::Key::F7 || keyPressed->code == sf::Keyboard::Key::F8)
+                {
+                    if (frameCapture.isCapturing())
+                        frameCapture.stop();
+                    else
+                    {
+                        CaptureSettings captureSettings;
+                        if (keyPressed->code == sf::Keyboard::Key::F8)
+                        {
+                            captureSettings.format = CAPTURE_FORMAT_PNG_SEQUENCE;
+                            captureSettings.path = "capture";
+                        }
+                        frameCapture.start(captureSettings, window.getSize());
+                    }
+                }
+            }
         }
 
-        pState->update(elapsedTime.asSeconds());
+        const InputSnapshot& input = Input::beginFrame(elapsedTime.asSeconds());
+        if (!Input::isSourceActive())
+            window.close();
+
+        {
+            PROFILE_SCOPE("ResourceManager::update");
+            ResourceManager::update();
+        }
+        {
+            PROFILE_SCOPE("State::update");
+            pState->update(input.dt);
+        }
         window.clear();
-        pState->render(window);
-        window.display();
+        {
+            PROFILE_SCOPE("State::render");
+            pState->render(window);
+        }
+        debugHud.render(window);
+        // Present time is left out; with vsync it would always read as a full frame
+        FrameGovernor::endFrame(static_cast<float>(Profiler::nowNs() - frameStartNs) / 1e6f);
+        // After the governor so recording does not lower the quality being recorded
+        frameCapture.capture(window);
+        {
+            PROFILE_SCOPE("Window::display");
+            window.display();
+        }
 
         gamestates.performDeferredPops();
+        JobSystem::endFrame();
+        FrameArena::reset();
+        Profiler::endFrame();
+
+        AllocationTracker::endFrame();
+        const AllocationFrameCounts& allocations = AllocationTracker::getLastFrame();
+        Telemetry::set(heapAllocationsCounter, static_cast<double>(allocations.allocations));
+        Telemetry::set(heapBytesCounter, static_cast<double>(allocations.bytes));
+        Telemetry::endFrame(elapsedTime.asSeconds());
     }
-    
+
+    if (Profiler::isCapturing())
+        Profiler::stopCapture("trace.json");
+    Telemetry::setRecording(false);
+    Input::setRecording(false);
+    // States go first; a pipelined step may still be using the job pool
+    gamestates.clear();
+    StatePlaying::releasePool();
+    frameCapture.stop();
+    ResourceManager::shutdown();
+    ScoreStore::shutdown();
+    JobSystem::shutdown();
+
+    Log::shutdown();
     return 0;
 }
@@ -0,0 +1,146 @@
+#include "EmitterSystem.h"
+#include "ParticleWorld.h"
+#include "Constants.h"
+#include "core/FrameArena.h"
+#include "core/Profiler.h"
+#include "core/SpawnBudget.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Shortest a phase can last, so a schedule of zero-length phases cannot keep
+	// the phase loop in update() going forever
+	constexpr float MinPhaseDuration = 0.01f;
+}
+
+void EmitterSystem::setSeed(uint32_t newSeed)
+{
+	seed = newSeed;
+	random.setSeed(seed);
+}
+
+void EmitterSystem::startPhase(Emitter& emitter, size_t phase)
+{
+	emitter.phase = phase;
+	if (emitter.desc.schedule.empty())
+		return;
+	const MaterialPhase& current = emitter.desc.schedule[phase];
+	emitter.phaseTimeLeft = std::max(MinPhaseDuration, random.range(current.minDuration, current.maxDuration));
+}
+
+size_t EmitterSystem::addEmitter(const EmitterDesc& desc)
+{
+	Emitter emitter;
+	emitter.desc = desc;
+	startPhase(emitter, 0);
+	emitters.push_back(emitter);
+	return emitters.size() - 1;
+}
+
+void EmitterSystem::setSpawnBudget(SpawnBudget* pBudget, const size_t (&pools)[MAT_ID_COUNT])
+{
+	spawnBudget = pBudget;
+	std::copy(pools, pools + MAT_ID_COUNT, materialPools);
+}
+
+void EmitterSystem::reset()
+{
+	random.setSeed(seed);
+	for (Emitter& emitter : emitters)
+	{
+		emitter.accumulator = 0.f;
+		emitter.emitted = 0;
+		emitter.dropped = 0;
+		startPhase(emitter, 0);
+	}
+}
+
+void EmitterSystem::update(float dt, ParticleWorld& world)
+{
+	PROFILE_SCOPE("EmitterSystem::update");
+	for (Emitter& emitter : emitters)
+	{
+		// Advance the material schedule; a long frame may skip several phases
+		if (!emitter.desc.schedule.empty())
+		{
+			emitter.phaseTimeLeft -= dt;
+			while (emitter.phaseTimeLeft <= 0.f)
+			{
+				float overshoot = emitter.phaseTimeLeft;
+				startPhase(emitter, (emitter.phase + 1) % emitter.desc.schedule.size());
+				emitter.phaseTimeLeft += overshoot;
+			}
+		}
+
+		emitter.accumulator += emitter.desc.rate * dt;
+		int count = static_cast<int>(std::floor(emitter.accumulator));
+		if (count <= 0)
+			continue;
+		emitter.accumulator -= static_cast<float>(count);
+
+		if (count > emitter.desc.budgetPerFrame)
+		{
+			emitter.dropped += static_cast<uint64_t>(count - emitter.desc.budgetPerFrame);
+			count = emitter.desc.budgetPerFrame;
+		}
+		if (count > 0 && !emitter.desc.schedule.empty())
+			emit(emitter, count, world);
+	}
+}
+
+void EmitterSystem::emit(Emitter& emitter, int count, ParticleWorld& world)
+{
+	const EmitterDesc& desc = emitter.desc;
+	int mat_id = desc.schedule[emitter.phase].mat_id;
+	size_t pool = spawnBudget ? materialPools[mat_id] : SIZE_MAX;
+	uint32_t live = world.getStats().cellsPerMaterial[mat_id];
+
+	switch (desc.shape)
+	{
+		case EMITTER_SHAPE_POINTS:
+		{
+			if (pool != SIZE_MAX)
+			{
+				int granted = static_cast<int>(spawnBudget->request(pool, live, static_cast<uint32_t>(count)));
+				emitter.dropped += static_cast<uint64_t>(count - granted);
+				count = granted;
+				if (count == 0)
+					return;
+			}
+			sf::Vector2f* positions = FrameArena::allocateArray<sf::Vector2f>(count);
+			for (int i = 0; i < count; ++i)
+				positions[i] = {random.range(desc.areaMin.x, desc.areaMax.x),
+								random.range(desc.areaMin.y, desc.areaMax.y)};
+			world.addParticles(positions, count, mat_id);
+			break;
+		}
+		case EMITTER_SHAPE_BLOB:
+		{
+			int placed = 0;
+			for (int i = 0; i < count; ++i)
+			{
+				sf::Vector2f center(random.range(desc.areaMin.x, desc.areaMax.x),
+									random.range(desc.areaMin.y, desc.areaMax.y));
+				float radius = random.range(desc.minRadius, desc.maxRadius);
+
+				// A blob is all or nothing; ask for roughly the cells it will cover
+				if (pool != SIZE_MAX)
+				{
+					float cellRadius = radius / ParticleScale;
+					uint32_t cells = static_cast<uint32_t>(3.14159265f * cellRadius * cellRadius * desc.density);
+					if (spawnBudget->request(pool, live, cells, true) == 0)
+					{
+						emitter.dropped++;
+						continue;
+					}
+				}
+				world.scatterCircle(center, radius, desc.density, mat_id);
+				placed++;
+			}
+			count = placed;
+			break;
+		}
+	}
+	emitter.emitted += static_cast<uint64_t>(count);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Particle.h"
+#include "core/Random.h"
+
+class ParticleWorld;
+class SpawnBudget;
+
+enum EmitterShape
+{
+	EMITTER_SHAPE_POINTS = 0,	// One cell per emission
+	EMITTER_SHAPE_BLOB = 1		// One scattered circle per emission
+};
+
+// A material held for a random duration before the schedule moves on
+struct MaterialPhase
+{
+	int		mat_id;
+	float	minDuration;
+	float	maxDuration;
+};
+
+struct EmitterDesc
+{
+	float						rate = 0.f;				// Emissions per second
+	EmitterShape				shape = EMITTER_SHAPE_POINTS;
+	sf::Vector2f				areaMin;				// Emission positions are uniform in this box
+	sf::Vector2f				areaMax;
+	float						minRadius = 0.f;		// Blob radius range in pixels
+	float						maxRadius = 0.f;
+	float						density = 1.f;			// Blob fill fraction
+	std::vector<MaterialPhase>	schedule;				// Cycled in order
+	int							budgetPerFrame = 1;		// Emissions beyond this in one frame are dropped
+};
+
+// Owns all particle emitters of a session. Emission uses a fractional
+// accumulator per emitter, so the spawn rate does not depend on frame rate,
+// and each emitter makes a single bulk ParticleWorld call per frame.
+class EmitterSystem
+{
+	public:
+		size_t addEmitter(const EmitterDesc& desc);
+		void setRate(size_t emitter, float rate) { emitters[emitter].desc.rate = rate; }
+		// Emission positions, sizes and phase lengths come from the system's own
+		// generator. The seed applies to what is drawn after it, and reset() goes back to it.
+		void setSeed(uint32_t seed);
+		void reset();
+
+		// Emissions ask the budget for room in their material's pool first; pools are
+		// indexed by material id and SIZE_MAX marks a material without a cap
+		void setSpawnBudget(SpawnBudget* pBudget, const size_t (&materialPools)[MAT_ID_COUNT]);
+
+		void update(float dt, ParticleWorld& world);
+
+		uint64_t getEmittedCount(size_t emitter) const { return emitters[emitter].emitted; }
+		uint64_t getDroppedCount(size_t emitter) const { return emitters[emitter].dropped; }
+		size_t getEmitterCount() const { return emitters.size(); }
+
+	private:
+		struct Emitter
+		{
+			EmitterDesc	desc;
+			float		accumulator = 0.f;
+			size_t		phase = 0;
+			float		phaseTimeLeft = 0.f;
+			uint64_t	emitted = 0;
+			uint64_t	dropped = 0;
+		};
+
+		std::vector<Emitter>		emitters;
+		SpawnBudget*				spawnBudget = nullptr;
+		size_t						materialPools[MAT_ID_COUNT] = {};
+		uint32_t					seed = Random::DefaultSeed;
+		Random						random;
+
+		void startPhase(Emitter& emitter, size_t phase);
+		void emit(Emitter& emitter, int count, ParticleWorld& world);
+};
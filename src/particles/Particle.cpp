@@ -10,6 +10,8 @@ Particle::Particle(int _id, float _lifetime, sf::Vector2f _velocity, sf::Color _
 		lifetime = MAT_WOOD_LIFETIME;
 	if (id == MAT_ID_FIRE)
 		lifetime = MAT_FIRE_LIFETIME;
+	if (id == MAT_ID_SMOKE)
+		lifetime = MAT_SMOKE_LIFETIME;
 }
 
 bool Particle::burn(float dt) {
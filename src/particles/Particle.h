@@ -18,7 +18,8 @@ enum MaterialID
 	MAT_ID_OIL = 5,
 	MAT_ID_FIRE = 6,
 	MAT_ID_WOODFIRE = 7,
-	MAT_ID_SMOKE = 8
+	MAT_ID_SMOKE = 8,
+	MAT_ID_COUNT
 };
 
 class Particle
@@ -26,7 +27,6 @@ class Particle
 	public:
 	    Particle() = default;
 		Particle(int id, float lifetime, sf::Vector2f velocity, sf::Color color);
-	    ~Particle() {}
 
 		inline void setHasBeenUpdated(bool updated) { has_been_updated = updated; }
 		inline void setVelocity(const sf::Vector2f& vel) { velocity = vel; }
@@ -53,7 +53,7 @@ class Particle
 		sf::Color		color = sf::Color::White;
 		bool			has_been_updated = false;
 		int				isSideMoving = 0;
-		int			    dispersityRate;
+		int			    dispersityRate = 4;
 		bool			isFlammable = false;
 		bool			isOnFire = false;
 };
\ No newline at end of file
@@ -1,19 +1,430 @@
 #include "ParticleWorld.h"
+#include "Reactions.h"
 #include "Constants.h"
-#include <SFML/Graphics/RenderTarget.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include "core/FrameArena.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+#include "core/Profiler.h"
+
+namespace
+{
+	constexpr int CHUNKS_X = (GRID_WIDTH + ParticleWorld::CHUNK_SIZE - 1) / ParticleWorld::CHUNK_SIZE;
+	constexpr int CHUNKS_Y = (GRID_HEIGHT + ParticleWorld::CHUNK_SIZE - 1) / ParticleWorld::CHUNK_SIZE;
+	constexpr uint32_t ResetPassChunkColumnsPerJob = 4;
+
+	// A free particle slower than this, cells per second, with something under it lands
+	constexpr float FreeParticleRestSpeed = 4.0f;
+	// How far up a landing cell looks for room when the grid has filled its spot
+	constexpr int LandingSearchCells = 4;
+
+	constexpr uint32_t ChunkHashSeed = 2166136261u;	// FNV-1a
+	constexpr uint32_t ChunkHashPrime = 16777619u;
+
+	bool isLooseMaterial(int mat_id)
+	{
+		return mat_id == MAT_ID_SAND || mat_id == MAT_ID_WATER || mat_id == MAT_ID_FIRE;
+	}
+}
+
+void FreeParticleBuffer::push(float px, float py, float vx, float vy, const Particle& cell)
+{
+	x.push_back(px);
+	y.push_back(py);
+	previousX.push_back(px);
+	previousY.push_back(py);
+	velocityX.push_back(vx);
+	velocityY.push_back(vy);
+	cells.push_back(cell);
+}
+
+void FreeParticleBuffer::removeAt(size_t i)
+{
+	size_t last = cells.size() - 1;
+	x[i] = x[last];
+	y[i] = y[last];
+	previousX[i] = previousX[last];
+	previousY[i] = previousY[last];
+	velocityX[i] = velocityX[last];
+	velocityY[i] = velocityY[last];
+	cells[i] = cells[last];
+	x.pop_back();
+	y.pop_back();
+	previousX.pop_back();
+	previousY.pop_back();
+	velocityX.pop_back();
+	velocityY.pop_back();
+	cells.pop_back();
+}
+
+void FreeParticleBuffer::clear()
+{
+	x.clear();
+	y.clear();
+	previousX.clear();
+	previousY.clear();
+	velocityX.clear();
+	velocityY.clear();
+	cells.clear();
+}
 
 ParticleWorld::ParticleWorld()
 {
-	particles.resize(GRID_WIDTH);
-	for (auto &col : particles)
-		col.resize(GRID_HEIGHT);
+	particles.resize(GRID_WIDTH * GRID_HEIGHT);
+	dirtyChunks.resize(CHUNKS_X * CHUNKS_Y, 1);
+	awakeChunks.resize(CHUNKS_X * CHUNKS_Y, 0);
+	reactionMasks.resize(GRID_WIDTH * GRID_HEIGHT, 0);
+	waterChunks.resize(CHUNKS_X * CHUNKS_Y);
+	waterLabels.resize(GRID_WIDTH * GRID_HEIGHT, 0);
+	waterInterior.resize(GRID_WIDTH * GRID_HEIGHT, 0);
+	waterLabelBase.resize(CHUNKS_X * CHUNKS_Y + 1, 0);
+	waterBodyParents.reserve(CHUNKS_X * CHUNKS_Y * MaxWaterLabels);
+	waterBodySettled.reserve(CHUNKS_X * CHUNKS_Y * MaxWaterLabels);
+}
+
+void ParticleWorld::setCells(const Particle* cells)
+{
+	std::copy(cells, cells + particles.size(), particles.begin());
+	freeParticles.clear();
+	std::fill(dirtyChunks.begin(), dirtyChunks.end(), 1);
+}
+
+void ParticleWorld::reset()
+{
+	std::fill(particles.begin(), particles.end(), Particle());
+	freeParticles.clear();
+	std::fill(dirtyChunks.begin(), dirtyChunks.end(), 1);
+	std::fill(awakeChunks.begin(), awakeChunks.end(), 0);
+	waterBodies.clear();
+	stats = ParticleWorldStats();
+	settings = ParticleWorldSettings();
+	random.setSeed(randomSeed);
+	frame_count = 0;
+	leftwardMoveTimer = 0.0f;
+	shouldMoveLeftThisFrame = false;
 }
 
 Particle &ParticleWorld::getParticleAt(int x, int y)
 {
-	return particles[x][y];
+	return particles[x * GRID_HEIGHT + y];
+}
+
+void ParticleWorld::swapParticles(Particle& a, Particle& b)
+{
+	std::swap(a, b);
+	stats.swaps++;
+}
+
+void ParticleWorld::markChunksDirty(int minX, int minY, int maxX, int maxY)
+{
+	for (int cy = minY / CHUNK_SIZE; cy <= maxY / CHUNK_SIZE; ++cy)
+		for (int cx = minX / CHUNK_SIZE; cx <= maxX / CHUNK_SIZE; ++cx)
+			dirtyChunks[cy * CHUNKS_X + cx] = 1;
+}
+
+void ParticleWorld::setSeed(uint32_t seed)
+{
+	randomSeed = seed;
+	random.setSeed(seed);
+}
+
+void ParticleWorld::fillColumnSpan(int x, int y0, int y1, const Particle& prototype)
+{
+	Particle* column = &particles[x * GRID_HEIGHT];
+	std::fill(column + y0, column + y1 + 1, prototype);
+}
+
+void ParticleWorld::scatterColumnSpan(int x, int y0, int y1, const Particle& prototype, uint32_t threshold)
+{
+	Particle* column = &particles[x * GRID_HEIGHT];
+	for (int y = y0; y <= y1; ++y)
+	{
+		if (nextRandom() <= threshold)
+			column[y] = prototype;
+	}
+}
+
+void ParticleWorld::addParticles(const sf::Vector2f* positions, size_t count, int mat_id)
+{
+	const Particle prototype(mat_id, 5.f, sf::Vector2f(0.f, 0.f), sf::Color::White);
+	int minX = GRID_WIDTH, minY = GRID_HEIGHT, maxX = -1, maxY = -1;
+	for (size_t i = 0; i < count; ++i)
+	{
+		int x = static_cast<int>(std::floor(positions[i].x / ParticleScale));
+		int y = static_cast<int>(std::floor(positions[i].y / ParticleScale));
+		if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT)
+			continue;
+
+		getParticleAt(x, y) = prototype;
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+	}
+	if (maxX >= 0)
+		markChunksDirty(minX, minY, maxX, maxY);
+}
+
+void ParticleWorld::fillRect(const sf::Vector2f& position, const sf::Vector2f& size, int mat_id)
+{
+	// Cells whose centres fall inside the rectangle, clipped to the grid once
+	int minX = std::max(0, static_cast<int>(std::ceil(position.x / ParticleScale - 0.5f)));
+	int minY = std::max(0, static_cast<int>(std::ceil(position.y / ParticleScale - 0.5f)));
+	int maxX = std::min(GRID_WIDTH - 1, static_cast<int>(std::floor((position.x + size.x) / ParticleScale - 0.5f)));
+	int maxY = std::min(GRID_HEIGHT - 1, static_cast<int>(std::floor((position.y + size.y) / ParticleScale - 0.5f)));
+	if (minX > maxX || minY > maxY)
+		return;
+
+	const Particle prototype(mat_id, 5.f, sf::Vector2f(0.f, 0.f), sf::Color::White);
+	for (int x = minX; x <= maxX; ++x)
+		fillColumnSpan(x, minY, maxY, prototype);
+	markChunksDirty(minX, minY, maxX, maxY);
+}
+
+void ParticleWorld::fillCircle(const sf::Vector2f& center, float radius, int mat_id)
+{
+	scatterCircle(center, radius, 1.0f, mat_id);
+}
+
+void ParticleWorld::scatterCircle(const sf::Vector2f& center, float radius, float density, int mat_id)
+{
+	if (density <= 0.f || radius <= 0.f)
+		return;
+
+	float cx = center.x / ParticleScale;
+	float cy = center.y / ParticleScale;
+	float r = radius / ParticleScale;
+
+	int minX = std::max(0, static_cast<int>(std::ceil(cx - r - 0.5f)));
+	int maxX = std::min(GRID_WIDTH - 1, static_cast<int>(std::floor(cx + r - 0.5f)));
+	int minY = std::max(0, static_cast<int>(std::ceil(cy - r - 0.5f)));
+	int maxY = std::min(GRID_HEIGHT - 1, static_cast<int>(std::floor(cy + r - 0.5f)));
+	if (minX > maxX || minY > maxY)
+		return;
+
+	const Particle prototype(mat_id, 5.f, sf::Vector2f(0.f, 0.f), sf::Color::White);
+	const bool solid = density >= 1.0f;
+	const uint32_t threshold = static_cast<uint32_t>(static_cast<double>(density) * 0xFFFFFFFFu);
+
+	// One vertical span per column: the cells whose centres lie inside the circle
+	for (int x = minX; x <= maxX; ++x)
+	{
+		float dx = (static_cast<float>(x) + 0.5f) - cx;
+		float halfHeightSq = r * r - dx * dx;
+		if (halfHeightSq < 0.f)
+			continue;
+		float halfHeight = std::sqrt(halfHeightSq);
+		int y0 = std::max(minY, static_cast<int>(std::ceil(cy - halfHeight - 0.5f)));
+		int y1 = std::min(maxY, static_cast<int>(std::floor(cy + halfHeight - 0.5f)));
+		if (y0 > y1)
+			continue;
+
+		if (solid)
+			fillColumnSpan(x, y0, y1, prototype);
+		else
+			scatterColumnSpan(x, y0, y1, prototype, threshold);
+	}
+	markChunksDirty(minX, minY, maxX, maxY);
+}
+
+void ParticleWorld::drawLine(const sf::Vector2f& from, const sf::Vector2f& to, int mat_id)
+{
+	// Liang-Barsky clip against the grid so the raster loop needs no bounds checks
+	float x0 = from.x / ParticleScale, y0 = from.y / ParticleScale;
+	float dx = to.x / ParticleScale - x0, dy = to.y / ParticleScale - y0;
+	float tMin = 0.f, tMax = 1.f;
+	const float p[4] = {-dx, dx, -dy, dy};
+	const float q[4] = {x0, (GRID_WIDTH - 1) - x0, y0, (GRID_HEIGHT - 1) - y0};
+	for (int i = 0; i < 4; ++i)
+	{
+		if (p[i] == 0.f)
+		{
+			if (q[i] < 0.f)
+				return;
+			continue;
+		}
+		float t = q[i] / p[i];
+		if (p[i] < 0.f)
+			tMin = std::max(tMin, t);
+		else
+			tMax = std::min(tMax, t);
+		if (tMin > tMax)
+			return;
+	}
+
+	int ax = static_cast<int>(x0 + tMin * dx), ay = static_cast<int>(y0 + tMin * dy);
+	int bx = static_cast<int>(x0 + tMax * dx), by = static_cast<int>(y0 + tMax * dy);
+	markChunksDirty(std::min(ax, bx), std::min(ay, by), std::max(ax, bx), std::max(ay, by));
+
+	// Bresenham
+	const Particle prototype(mat_id, 5.f, sf::Vector2f(0.f, 0.f), sf::Color::White);
+	int stepX = ax < bx ? 1 : -1, stepY = ay < by ? 1 : -1;
+	int errX = std::abs(bx - ax), errY = -std::abs(by - ay);
+	int err = errX + errY;
+	while (true)
+	{
+		getParticleAt(ax, ay) = prototype;
+		if (ax == bx && ay == by)
+			break;
+		int e2 = 2 * err;
+		if (e2 >= errY)
+		{
+			err += errY;
+			ax += stepX;
+		}
+		if (e2 <= errX)
+		{
+			err += errX;
+			ay += stepY;
+		}
+	}
+}
+
+size_t ParticleWorld::applyImpulse(const sf::Vector2f& center, float radius, const sf::Vector2f& velocity)
+{
+	if (radius <= 0.f)
+		return 0;
+
+	float cx = center.x / ParticleScale;
+	float cy = center.y / ParticleScale;
+	float r = radius / ParticleScale;
+	int minX = std::max(0, static_cast<int>(std::floor(cx - r)));
+	int maxX = std::min(GRID_WIDTH - 1, static_cast<int>(std::floor(cx + r)));
+	int minY = std::max(1, static_cast<int>(std::floor(cy - r)));
+	int maxY = std::min(GRID_HEIGHT - 1, static_cast<int>(std::floor(cy + r)));
+	if (minX > maxX || minY > maxY)
+		return 0;
+
+	const float vx = velocity.x / ParticleScale;
+	const float vy = velocity.y / ParticleScale;
+	size_t thrown = 0;
+	for (int x = minX; x <= maxX; ++x)
+	{
+		Particle* column = &particles[x * GRID_HEIGHT];
+		for (int y = minY; y <= maxY; ++y)
+		{
+			if (!isLooseMaterial(column[y].getId()) || freeParticles.size() >= MaxFreeParticles)
+				continue;
+
+			float dx = static_cast<float>(x) + 0.5f - cx;
+			float dy = static_cast<float>(y) + 0.5f - cy;
+			float distSq = dx * dx + dy * dy;
+			if (distSq >= r * r)
+				continue;
+
+			// Some spread, so a splash fans out rather than flying off as one block
+			float falloff = 1.0f - std::sqrt(distSq) / r;
+			float scale = falloff * (0.75f + 0.5f * nextRandomFloat());
+			freeParticles.push(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, vx * scale, vy * scale, column[y]);
+			column[y] = Particle();
+			thrown++;
+		}
+	}
+	if (thrown > 0)
+		markChunksDirty(minX, minY, maxX, maxY);
+	return thrown;
+}
+
+void ParticleWorld::updateFreeParticles(float dt)
+{
+	PROFILE_SCOPE("ParticleWorld::updateFreeParticles");
+	FreeParticleBuffer& flying = freeParticles;
+	size_t count = flying.size();
+	float* x = flying.x.data();
+	float* y = flying.y.data();
+	float* previousX = flying.previousX.data();
+	float* previousY = flying.previousY.data();
+	float* velocityX = flying.velocityX.data();
+	float* velocityY = flying.velocityY.data();
+	const float gravityX = gravity.x * dt;
+	const float gravityY = gravity.y * dt;
+	for (size_t i = 0; i < count; ++i)
+	{
+		previousX[i] = x[i];
+		previousY[i] = y[i];
+		velocityX[i] += gravityX;
+		velocityY[i] += gravityY;
+		x[i] += velocityX[i] * dt;
+		y[i] += velocityY[i] * dt;
+	}
+
+	// Landing reads the grid, so it stays scalar. Going backwards, a landed
+	// particle's slot is refilled by one that has already been looked at.
+	for (size_t i = count; i-- > 0;)
+		landFreeParticle(i);
+	stats.freeParticles = static_cast<uint32_t>(flying.size());
+}
+
+bool ParticleWorld::landFreeParticle(size_t i)
+{
+	FreeParticleBuffer& flying = freeParticles;
+	float x0 = flying.previousX[i];
+	float y0 = flying.previousY[i];
+	float dx = flying.x[i] - x0;
+	float dy = flying.y[i] - y0;
+	int cellX = static_cast<int>(std::floor(x0));
+	int cellY = static_cast<int>(std::floor(y0));
+
+	// Walk the step one cell at a time so fast particles cannot pass through thin walls
+	bool hasHit = false;
+	int steps = std::max(1, static_cast<int>(std::ceil(std::max(std::abs(dx), std::abs(dy)))));
+	for (int s = 1; s <= steps; ++s)
+	{
+		float t = static_cast<float>(s) / static_cast<float>(steps);
+		int nx = static_cast<int>(std::floor(x0 + dx * t));
+		int ny = static_cast<int>(std::floor(y0 + dy * t));
+		if (nx == cellX && ny == cellY)
+			continue;
+
+		// Off the sides it is gone, like cells scrolled off the left edge; above the
+		// top row there is nothing to hit
+		if (nx < 0 || nx >= GRID_WIDTH)
+		{
+			flying.removeAt(i);
+			return true;
+		}
+		if (ny >= GRID_HEIGHT || (ny >= 1 && getParticleAt(nx, ny).getId() != MAT_ID_EMPTY))
+		{
+			hasHit = true;
+			break;
+		}
+		cellX = nx;
+		cellY = ny;
+	}
+
+	if (!hasHit)
+	{
+		float speedSq = flying.velocityX[i] * flying.velocityX[i] + flying.velocityY[i] * flying.velocityY[i];
+		bool isSupported = cellY >= 1 && (cellY + 1 >= GRID_HEIGHT || getParticleAt(cellX, cellY + 1).getId() != MAT_ID_EMPTY);
+		if (speedSq > FreeParticleRestSpeed * FreeParticleRestSpeed || !isSupported)
+			return false;
+	}
+
+	// Back into the last empty cell on the path, or the nearest free one above it
+	// if grid movement has filled that since
+	for (int y = cellY; y >= std::max(1, cellY - LandingSearchCells); --y)
+	{
+		Particle& cell = getParticleAt(cellX, y);
+		if (cell.getId() != MAT_ID_EMPTY)
+			continue;
+
+		// Grid cells move one step at a time; the flight speed does not carry over
+		cell = flying.cells[i];
+		cell.setVelocity(sf::Vector2f(0.f, 0.f));
+		markChunksDirty(cellX, y, cellX, y);
+		stats.landedParticles++;
+		flying.removeAt(i);
+		return true;
+	}
+
+	// Nowhere to go, or stopped above the visible rows: it waits in the last empty
+	// cell it passed and tries again next step rather than being lost
+	flying.x[i] = static_cast<float>(cellX) + 0.5f;
+	flying.y[i] = static_cast<float>(cellY) + 0.5f;
+	flying.velocityX[i] = 0.f;
+	flying.velocityY[i] = 0.f;
+	return false;
 }
 
 void ParticleWorld::addParticle(const sf::Vector2f &position, sf::Vector2f velocity, int mat_id)
@@ -22,11 +433,12 @@ void ParticleWorld::addParticle(const sf::Vector2f &position, sf::Vector2f veloc
 	int y = static_cast<int>(position.y) / ParticleScale;
 	if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT)
 	{
-		std::cout << "Attempted to add particle out of bounds at (" << x << ", " << y << ")\n";
+		LOG_DEBUG("Attempted to add particle out of bounds at ({}, {})", x, y);
 		return;
 	}
 
-	particles[x][y] = Particle(mat_id, 5.f, velocity, sf::Color::White);
+	getParticleAt(x, y) = Particle(mat_id, 5.f, velocity, sf::Color::White);
+	markChunksDirty(x, y, x, y);
 }
 
 void ParticleWorld::updateSand(int x, int y)
@@ -56,14 +468,14 @@ void ParticleWorld::updateSand(int x, int y)
 		// If we can fall straight down, do it
 		if (fallDistance > 0)
 		{
-			std::swap(sand, getParticleAt(x, y + fallDistance));
+			swapParticles(sand, getParticleAt(x, y + fallDistance));
 			return;
 		}
 
 		Particle& below = getParticleAt(x, y + 1);
 		if (below.getId() == MAT_ID_WATER)
 		{
-			std::swap(sand, below);
+			swapParticles(sand, below);
 			return;
 		}
 
@@ -74,7 +486,7 @@ void ParticleWorld::updateSand(int x, int y)
 			if (belowLeft.getId() == MAT_ID_EMPTY
 				|| belowLeft.getId() == MAT_ID_WATER)
 			{
-				std::swap(sand, belowLeft);
+				swapParticles(sand, belowLeft);
 				return;
 			}
 		}
@@ -85,7 +497,7 @@ void ParticleWorld::updateSand(int x, int y)
 			if (belowRight.getId() == MAT_ID_EMPTY
 				|| belowRight.getId() == MAT_ID_WATER)
 			{
-				std::swap(sand, belowRight);
+				swapParticles(sand, belowRight);
 				return;
 			}
 		}
@@ -99,7 +511,7 @@ void ParticleWorld::updateSand(int x, int y)
 			Particle& left = getParticleAt(x - 1, y);
 			if (left.getId() == MAT_ID_EMPTY)
 			{
-				std::swap(sand, left);
+				swapParticles(sand, left);
 				return;
 			}
 		}
@@ -118,6 +530,13 @@ void ParticleWorld::updateWater(int x, int y)
 		return;
 	water.setHasBeenUpdated(true);
 
+	// Surrounded by a body that has nowhere to go, there is nothing to try
+	if (isSettledWaterInterior(x, y))
+	{
+		stats.skippedWater++;
+		return;
+	}
+
 	if (y + 1 < GRID_HEIGHT)  // Check downward
 	{	
 		// Try to fall as far as velocity allows
@@ -138,100 +557,38 @@ void ParticleWorld::updateWater(int x, int y)
 		// If we can fall straight down, do it
 		if (fallDistance > 0)
 		{
-			if (fallDistance == 1 && getParticleAt(x, y + 1).getId() == MAT_ID_FIRE)
-				getParticleAt(x, y + 1).setId(MAT_ID_EMPTY);
-			std::swap(water, getParticleAt(x, y + fallDistance));
+			swapParticles(water, getParticleAt(x, y + fallDistance));
 			return;
 		}
 
-		if (rand() % 2 == 0)
-		{
-			// Try left first
-			if (x > 0)
-			{
-				Particle& belowLeft = getParticleAt(x - 1, y + 1);
-				int id = belowLeft.getId();
-				if (id == MAT_ID_FIRE)
-				{
-					belowLeft.setId(MAT_ID_EMPTY);
-					return;
-				}
-				else if (id == MAT_ID_EMPTY)
-				{
-					std::swap(water, belowLeft);
-					return;
-				}
-			}
-			// Then try right
-			if (x + 1 < GRID_WIDTH)
-			{
-				Particle& belowRight = getParticleAt(x + 1, y + 1);
-				int id = belowRight.getId();
-				if (id == MAT_ID_FIRE)
-				{
-					belowRight.setId(MAT_ID_EMPTY);
-					return;
-				}
-				else if (id == MAT_ID_EMPTY)
-				{
-					std::swap(water, belowRight);
-					return;
-				}
-			}
-		}
-		else
+		// Diagonals in a random order
+		int side = nextRandom() % 2 == 0 ? -1 : 1;
+		for (int attempt = 0; attempt < 2; ++attempt, side = -side)
 		{
-			if (x + 1 < GRID_WIDTH)
+			if (x + side < 0 || x + side >= GRID_WIDTH)
+				continue;
+			Particle& belowSide = getParticleAt(x + side, y + 1);
+			if (belowSide.getId() == MAT_ID_EMPTY)
 			{
-				Particle& belowRight = getParticleAt(x + 1, y + 1);
-				int id = belowRight.getId();
-				if (id == MAT_ID_FIRE)
-				{
-					belowRight.setId(MAT_ID_EMPTY);
-					return;
-				}
-				else if (id == MAT_ID_EMPTY)
-				{
-					std::swap(water, belowRight);
-					return;
-				}
-			}
-			if (x > 0)
-			{
-				Particle& belowLeft = getParticleAt(x - 1, y + 1);
-				int id = belowLeft.getId();
-				if (id == MAT_ID_FIRE)
-				{
-					belowLeft.setId(MAT_ID_EMPTY);
-					return;
-				}
-				else if (belowLeft.getId() == MAT_ID_EMPTY)
-				{
-					std::swap(water, belowLeft);
-					return;
-				}
+				swapParticles(water, belowSide);
+				return;
 			}
 		}
 	}
 	
 	// Only spread horizontally if we couldn't move down
-	int dispersityRate = water.getDispersityRate();
+	int dispersityRate = std::min(water.getDispersityRate(), settings.maxDispersity);
 	if (x - dispersityRate > 0 && x + dispersityRate + 1 < GRID_WIDTH)
 	{
-		if (rand() % 2 == 0)
+		if (nextRandom() % 2 == 0)
 		{
 			for (int i = 1; i <= dispersityRate; ++i)
 			{
 				Particle& left = getParticleAt(x - i, y);
 				int id = left.getId();
-				if (id == MAT_ID_FIRE)
-				{
-					left.setId(MAT_ID_EMPTY);
-					return;
-				}
 				if (id == MAT_ID_EMPTY)
 				{
-					std::swap(water, left);
+					swapParticles(water, left);
 					return;
 				}
 				if (id == MAT_ID_SAND)
@@ -244,14 +601,9 @@ void ParticleWorld::updateWater(int x, int y)
 			{
 				Particle& right = getParticleAt(x + i, y);
 				int id = right.getId();
-				if (id == MAT_ID_FIRE)
-				{
-					right.setId(MAT_ID_EMPTY);
-					return;
-				}
 				if (id == MAT_ID_EMPTY)
 				{
-					std::swap(water, right);
+					swapParticles(water, right);
 					return;
 				}
 				if (id == MAT_ID_SAND)
@@ -268,7 +620,7 @@ void ParticleWorld::updateWater(int x, int y)
 			Particle& left = getParticleAt(x - 1, y);
 			if (left.getId() == MAT_ID_EMPTY)
 			{
-				std::swap(water, left);
+				swapParticles(water, left);
 				return;
 			}
 		}
@@ -295,44 +647,8 @@ void ParticleWorld::updateWood(float dt, int x, int y)
 			wood.setId(MAT_ID_FIRE);
 			wood.setLifetime(MAT_FIRE_LIFETIME);
 			wood.setIsOnFire(false);
-			return;
-		}
-		
-		// Fire spreading - just set the fire flag, don't change material type
-		if (rand() % 8 == 0 && y + 1 >= 0 && y + 1 < GRID_HEIGHT)
-		{
-			Particle& below = getParticleAt(x, y + 1);
-			if (below.getId() == MAT_ID_WOOD && !below.getIsOnFire())
-			{
-				below.setIsOnFire(true);
-			}
-		}
-		if (rand() % 8 == 0 && x - 1 >= 0 && x - 1 < GRID_WIDTH)
-		{
-			Particle& left = getParticleAt(x - 1, y);
-			if (left.getId() == MAT_ID_WOOD && !left.getIsOnFire())
-			{
-				left.setIsOnFire(true);
-			}
-		}
-		if (rand() % 8 == 0 && x + 1 >= 0 && x + 1 < GRID_WIDTH)
-		{
-			Particle& right = getParticleAt(x + 1, y);
-			if (right.getId() == MAT_ID_WOOD && !right.getIsOnFire())
-			{
-				right.setIsOnFire(true);
-			}
-		}
-		if (rand() % 8 == 0 && y - 1 >= 0 && y - 1 < GRID_HEIGHT)
-		{
-			Particle& above = getParticleAt(x, y - 1);
-			if (above.getId() == MAT_ID_WOOD && !above.getIsOnFire())
-			{
-				above.setIsOnFire(true);
-			}
 		}
-		
-		return;
+		// Spreading to the wood around it is a reaction, handled by updateReactions()
 	}
 }
 
@@ -342,7 +658,6 @@ void ParticleWorld::updateFire(float dt, int x, int y)
 	if (fire.HasBeenUpdated())
 		return;
 	fire.setHasBeenUpdated(true);
-	int hasSpread = false;
 
 	if (fire.burn(dt))
 	{
@@ -350,126 +665,454 @@ void ParticleWorld::updateFire(float dt, int x, int y)
 		return;
 	}
 
+	// Water and anything it can ignite were dealt with by updateReactions()
+
+	// Try to fall down
 	if (y + 1 < GRID_HEIGHT)
 	{
 		Particle& below = getParticleAt(x, y + 1);
-		int id = below.getId();
-		if (id == MAT_ID_WATER)
+		if (below.getId() == MAT_ID_EMPTY)
 		{
-			fire.setId(MAT_ID_EMPTY);
+			swapParticles(fire, below);
 			return;	
 		}
-		if (id == MAT_ID_WOOD || id == MAT_ID_OIL)
-		{
-			below.setIsOnFire(true);
-			hasSpread = true;
-		}
 	}
-	if (x - 1 >= 0)
+	
+	// Try diagonal fall
+	if (y + 1 < GRID_HEIGHT && x - 1 >= 0)
 	{
-		Particle& left = getParticleAt(x - 1, y);
-		int id = left.getId();
-		if (id == MAT_ID_WATER)
+		Particle& belowLeft = getParticleAt(x - 1, y + 1);
+		if (belowLeft.getId() == MAT_ID_EMPTY)
 		{
-			fire.setId(MAT_ID_EMPTY);
-			return;	
+			swapParticles(fire, belowLeft);
+			return;
 		}
-		if (id == MAT_ID_WOOD || id == MAT_ID_OIL)
+	}
+	if (y + 1 < GRID_HEIGHT && x + 1 < GRID_WIDTH)
+	{
+		Particle& belowRight = getParticleAt(x + 1, y + 1);
+		if (belowRight.getId() == MAT_ID_EMPTY)
 		{
-			left.setIsOnFire(true);
-			hasSpread = true;
+			swapParticles(fire, belowRight);
+			return;
 		}
 	}
-	if (x + 1 < GRID_WIDTH)
+	
+	// Move left at the end if no other movement occurred (only when timer allows)
+	if (shouldMoveLeftThisFrame)
 	{
-		Particle& right = getParticleAt(x + 1, y);
-		int id = right.getId();
-		if (id == MAT_ID_WATER)
+		if (x > 0)
 		{
-			fire.setId(MAT_ID_EMPTY);
-			return;	
+			Particle& left = getParticleAt(x - 1, y);
+			if (left.getId() == MAT_ID_EMPTY)
+			{
+				swapParticles(fire, left);
+				return;
+			}
 		}
-		if (id == MAT_ID_WOOD || id == MAT_ID_OIL)
+		else if (x == 0)
 		{
-			right.setIsOnFire(true);
-			hasSpread = true;
+			fire.setId(MAT_ID_EMPTY);
 		}
 	}
-	if (y - 1 >= 0)
+}
+
+void ParticleWorld::updateSmoke(float dt, int x, int y)
+{
+	Particle& smoke = getParticleAt(x, y);
+	if (smoke.HasBeenUpdated())
+		return;
+	smoke.setHasBeenUpdated(true);
+
+	// Smoke thins out, and leaves through the top rather than piling up in the hidden row
+	if (smoke.burn(dt) || y <= 1)
+	{
+		smoke.setId(MAT_ID_EMPTY);
+		return;
+	}
+
+	Particle& above = getParticleAt(x, y - 1);
+	if (above.getId() == MAT_ID_EMPTY)
 	{
-		Particle& above = getParticleAt(x, y - 1);
-		int id = above.getId();
-		if (id == MAT_ID_WATER)
+		swapParticles(smoke, above);
+		return;
+	}
+
+	int side = nextRandom() % 2 == 0 ? -1 : 1;
+	for (int attempt = 0; attempt < 2; ++attempt, side = -side)
+	{
+		if (x + side < 0 || x + side >= GRID_WIDTH)
+			continue;
+		Particle& aboveSide = getParticleAt(x + side, y - 1);
+		if (aboveSide.getId() == MAT_ID_EMPTY)
 		{
-			fire.setId(MAT_ID_EMPTY);
-			return;	
+			swapParticles(smoke, aboveSide);
+			return;
 		}
-		if (id == MAT_ID_WOOD || id == MAT_ID_OIL)
+	}
+}
+
+void ParticleWorld::setReactionProduct(Particle& cell, uint8_t product, float heat)
+{
+	if (product != REACTION_KEEP)
+		cell = Particle(product, 5.f, sf::Vector2f(0.f, 0.f), sf::Color::White);
+	if (heat > 0.f && cell.getIsFlammable())
+		cell.setIsOnFire(true);
+	else if (heat < 0.f)
+		cell.setIsOnFire(false);
+}
+
+bool ParticleWorld::applyReagent(int x, int y, int reagent)
+{
+	if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT)
+		return false;
+
+	// The reagent is not a cell, so only product B has somewhere to go
+	Particle& cell = getParticleAt(x, y);
+	const Reaction& reaction = ReactionTable::get(reagent, ReactionTable::reactionId(cell));
+	if (reaction.probability <= 0.f
+		|| (reaction.probability < 1.f && nextRandomFloat() >= reaction.probability))
+		return false;
+
+	setReactionProduct(cell, reaction.productB, reaction.heat);
+	markChunksDirty(x, y, x, y);
+	return true;
+}
+
+void ParticleWorld::reactCell(int x, int y)
+{
+	static const int offsets[4][2] = {{0, 1}, {-1, 0}, {1, 0}, {0, -1}};
+	Particle& a = getParticleAt(x, y);
+
+	// At reduced quality a chance reaction rolls for one neighbour, at four times the
+	// odds, so each neighbour still catches at the table's rate
+	const bool singleRoll = settings.singleReactionRoll;
+	const int rolledNeighbour = singleRoll ? nextRandom() % 4 : -1;
+
+	// The cell meets all four neighbours as what it was when its turn came, so fire
+	// that burns out on the first wood it lights still lights the rest, as it always
+	// has. Products overwrite each other in neighbour order; what the cell became
+	// reacts as that from the next step.
+	const int aId = ReactionTable::reactionId(a);
+	for (int i = 0; i < 4; ++i)
+	{
+		int nx = x + offsets[i][0];
+		int ny = y + offsets[i][1];
+		if (nx < 0 || nx >= GRID_WIDTH || ny < 0 || ny >= GRID_HEIGHT)
+			continue;
+
+		// Masks are from the start of the step, so the neighbour is looked up again as it is now
+		Particle& b = getParticleAt(nx, ny);
+		const Reaction& reaction = ReactionTable::get(aId, ReactionTable::reactionId(b));
+		if (reaction.probability <= 0.f)
+			continue;
+		if (reaction.probability < 1.f)
 		{
-			// Just set the fire flag, don't change material type
-			above.setIsOnFire(true);
-			hasSpread = true;
+			float probability = reaction.probability;
+			if (singleRoll)
+			{
+				if (i != rolledNeighbour)
+					continue;
+				probability = std::min(1.f, probability * 4.f);
+			}
+			if (nextRandomFloat() >= probability)
+				continue;
 		}
+
+		setReactionProduct(a, reaction.productA, reaction.heat);
+		setReactionProduct(b, reaction.productB, reaction.heat);
+		stats.reactions++;
 	}
-	if (hasSpread)
+}
+
+void ParticleWorld::updateReactions()
+{
+	PROFILE_SCOPE("ParticleWorld::updateReactions");
+	// Only chunks with burning or moving cells can hold a reacting one, and within
+	// them a zero mask rules a cell out without looking at the table
+	for (int cy = 0; cy < CHUNKS_Y; ++cy)
 	{
-		fire.setId(MAT_ID_EMPTY);
-		return;
+		for (int cx = 0; cx < CHUNKS_X; ++cx)
+		{
+			if (!awakeChunks[cy * CHUNKS_X + cx])
+				continue;
+
+			int endX = std::min(GRID_WIDTH, (cx + 1) * CHUNK_SIZE);
+			int endY = std::min(GRID_HEIGHT, (cy + 1) * CHUNK_SIZE);
+			for (int x = cx * CHUNK_SIZE; x < endX; ++x)
+			{
+				const uint16_t* masks = &reactionMasks[x * GRID_HEIGHT];
+				for (int y = cy * CHUNK_SIZE; y < endY; ++y)
+				{
+					if (masks[y] != 0)
+						reactCell(x, y);
+				}
+			}
+		}
 	}
-	
-	// Try to fall down
+}
+
+bool ParticleWorld::canWaterFlowFrom(int x, int y) const
+{
+	// The moves updateWater() can make, without making them
+	const Particle* column = &particles[x * GRID_HEIGHT];
 	if (y + 1 < GRID_HEIGHT)
 	{
-		Particle& below = getParticleAt(x, y + 1);
-		if (below.getId() == MAT_ID_EMPTY)
+		if (column[y + 1].getId() == MAT_ID_EMPTY)
+			return true;
+		if (x > 0 && column[y + 1 - GRID_HEIGHT].getId() == MAT_ID_EMPTY)
+			return true;
+		if (x + 1 < GRID_WIDTH && column[y + 1 + GRID_HEIGHT].getId() == MAT_ID_EMPTY)
+			return true;
+	}
+
+	int dispersityRate = std::min(column[y].getDispersityRate(), settings.maxDispersity);
+	if (x - dispersityRate > 0 && x + dispersityRate + 1 < GRID_WIDTH)
+	{
+		for (int side = -1; side <= 1; side += 2)
 		{
-			std::swap(particles[x][y], particles[x][y + 1]);
-			return;	
+			for (int i = 1; i <= dispersityRate; ++i)
+			{
+				int id = column[y + side * i * GRID_HEIGHT].getId();
+				if (id == MAT_ID_EMPTY)
+					return true;
+				if (id == MAT_ID_SAND)
+					break;
+			}
 		}
 	}
-	
-	// Try diagonal fall
-	if (y + 1 < GRID_HEIGHT && x - 1 >= 0)
+
+	// The leftward scroll moves it on its own
+	return x == 0 || column[y - GRID_HEIGHT].getId() == MAT_ID_EMPTY;
+}
+
+void ParticleWorld::labelWaterChunk(int cx, int cy)
+{
+	WaterChunk& chunk = waterChunks[cy * CHUNKS_X + cx];
+	chunk.labelCount = 0;
+
+	int startX = cx * CHUNK_SIZE;
+	int startY = std::max(1, cy * CHUNK_SIZE);
+	int endX = std::min(GRID_WIDTH, startX + CHUNK_SIZE);
+	int endY = std::min(GRID_HEIGHT, (cy + 1) * CHUNK_SIZE);
+	for (int x = startX; x < endX; ++x)
 	{
-		Particle& belowLeft = getParticleAt(x - 1, y + 1);
-		if (belowLeft.getId() == MAT_ID_EMPTY)
+		for (int y = cy * CHUNK_SIZE; y < endY; ++y)
 		{
-			std::swap(particles[x][y], particles[x - 1][y + 1]);
-			return;
+			waterLabels[x * GRID_HEIGHT + y] = 0;
+			waterInterior[x * GRID_HEIGHT + y] = 0;
 		}
 	}
-	if (y + 1 < GRID_HEIGHT && x + 1 < GRID_WIDTH)
+
+	// 4-connected flood fill, kept inside the chunk; bodies are joined across
+	// chunk borders afterwards
+	int stack[CHUNK_SIZE * CHUNK_SIZE];
+	for (int x = startX; x < endX; ++x)
 	{
-		Particle& belowRight = getParticleAt(x + 1, y + 1);
-		if (belowRight.getId() == MAT_ID_EMPTY)
+		for (int y = startY; y < endY; ++y)
 		{
-			std::swap(particles[x][y], particles[x + 1][y + 1]);
-			return;
+			int index = x * GRID_HEIGHT + y;
+			if (waterLabels[index] != 0 || particles[index].getId() != MAT_ID_WATER)
+				continue;
+
+			int label = chunk.labelCount++;
+			chunk.volume[label] = 0;
+			chunk.surface[label] = 0;
+			chunk.isOpen[label] = 0;
+			waterLabels[index] = static_cast<uint8_t>(label + 1);
+			int stackSize = 0;
+			stack[stackSize++] = index;
+			while (stackSize > 0)
+			{
+				int cell = stack[--stackSize];
+				int cellX = cell / GRID_HEIGHT;
+				int cellY = cell % GRID_HEIGHT;
+
+				bool isInterior = cellX > 0;
+				const int neighbours[4][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+				for (const auto& offset : neighbours)
+				{
+					int nx = cellX + offset[0];
+					int ny = cellY + offset[1];
+					if (nx < 0 || nx >= GRID_WIDTH || ny >= GRID_HEIGHT)
+						continue;
+					int neighbour = nx * GRID_HEIGHT + ny;
+					if (particles[neighbour].getId() != MAT_ID_WATER)
+					{
+						isInterior = false;
+						continue;
+					}
+					if (nx >= startX && nx < endX && ny >= startY && ny < endY && waterLabels[neighbour] == 0)
+					{
+						waterLabels[neighbour] = static_cast<uint8_t>(label + 1);
+						stack[stackSize++] = neighbour;
+					}
+				}
+
+				waterInterior[cell] = isInterior;
+				chunk.volume[label]++;
+				if (particles[cell - 1].getId() == MAT_ID_EMPTY)
+					chunk.surface[label]++;
+				if (!chunk.isOpen[label] && canWaterFlowFrom(cellX, cellY))
+					chunk.isOpen[label] = 1;
+			}
 		}
 	}
-	
-	// Move left at the end if no other movement occurred (only when timer allows)
-	if (shouldMoveLeftThisFrame)
+}
+
+uint32_t ParticleWorld::findWaterBody(uint32_t label)
+{
+	while (waterBodyParents[label] != label)
 	{
-		if (x > 0)
+		waterBodyParents[label] = waterBodyParents[waterBodyParents[label]];
+		label = waterBodyParents[label];
+	}
+	return label;
+}
+
+bool ParticleWorld::isSettledWaterInterior(int x, int y) const
+{
+	int index = x * GRID_HEIGHT + y;
+	if (!waterInterior[index])
+		return false;
+	int chunk = (y / CHUNK_SIZE) * CHUNKS_X + x / CHUNK_SIZE;
+	return waterBodySettled[waterLabelBase[chunk] + waterLabels[index] - 1] != 0;
+}
+
+void ParticleWorld::updateWaterBodies()
+{
+	PROFILE_SCOPE("ParticleWorld::updateWaterBodies");
+	// Whether water can move depends on the cells a few columns around it, so a
+	// chunk is labelled again when it or a neighbour changed since it last was.
+	// Edits say so directly; the hash catches what the simulation itself moved.
+	bool relabelAll = waterLabelDispersity != settings.maxDispersity;
+	waterLabelDispersity = settings.maxDispersity;
+	uint8_t* changed = FrameArena::allocateZeroed<uint8_t>(CHUNKS_X * CHUNKS_Y);
+	for (int chunk = 0; chunk < CHUNKS_X * CHUNKS_Y; ++chunk)
+	{
+		WaterChunk& waterChunk = waterChunks[chunk];
+		changed[chunk] = relabelAll || dirtyChunks[chunk] || waterChunk.hash != waterChunk.pendingHash;
+		waterChunk.hash = waterChunk.pendingHash;
+	}
+	// Edits made later in this step are left for the next one
+	std::fill(dirtyChunks.begin(), dirtyChunks.end(), 0);
+	for (int cy = 0; cy < CHUNKS_Y; ++cy)
+	{
+		for (int cx = 0; cx < CHUNKS_X; ++cx)
 		{
-			Particle& left = getParticleAt(x - 1, y);
-			if (left.getId() == MAT_ID_EMPTY)
+			bool isStale = false;
+			for (int ny = std::max(0, cy - 1); ny <= std::min(CHUNKS_Y - 1, cy + 1) && !isStale; ++ny)
+				for (int nx = std::max(0, cx - 1); nx <= std::min(CHUNKS_X - 1, cx + 1) && !isStale; ++nx)
+					isStale = changed[ny * CHUNKS_X + nx] != 0;
+			if (isStale)
 			{
-				std::swap(particles[x][y], particles[x - 1][y]);
-				return;
+				labelWaterChunk(cx, cy);
+				stats.relabeledChunks++;
 			}
 		}
-		else if (x == 0)
+	}
+
+	// Union-find over every chunk's labels, joined where water touches across a border
+	uint32_t labelCount = 0;
+	for (int chunk = 0; chunk < CHUNKS_X * CHUNKS_Y; ++chunk)
+	{
+		waterLabelBase[chunk] = labelCount;
+		labelCount += waterChunks[chunk].labelCount;
+	}
+	waterLabelBase[CHUNKS_X * CHUNKS_Y] = labelCount;
+	waterBodyParents.resize(labelCount);
+	for (uint32_t label = 0; label < labelCount; ++label)
+		waterBodyParents[label] = label;
+
+	auto join = [this](int a, int b)
+	{
+		if (waterLabels[a] == 0 || waterLabels[b] == 0)
+			return;
+		int ax = a / GRID_HEIGHT, ay = a % GRID_HEIGHT;
+		int bx = b / GRID_HEIGHT, by = b % GRID_HEIGHT;
+		uint32_t rootA = findWaterBody(waterLabelBase[(ay / CHUNK_SIZE) * CHUNKS_X + ax / CHUNK_SIZE] + waterLabels[a] - 1);
+		uint32_t rootB = findWaterBody(waterLabelBase[(by / CHUNK_SIZE) * CHUNKS_X + bx / CHUNK_SIZE] + waterLabels[b] - 1);
+		if (rootA != rootB)
+			waterBodyParents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+	};
+	for (int x = CHUNK_SIZE; x < GRID_WIDTH; x += CHUNK_SIZE)
+		for (int y = 1; y < GRID_HEIGHT; ++y)
+			join((x - 1) * GRID_HEIGHT + y, x * GRID_HEIGHT + y);
+	for (int y = CHUNK_SIZE; y < GRID_HEIGHT; y += CHUNK_SIZE)
+		for (int x = 0; x < GRID_WIDTH; ++x)
+			join(x * GRID_HEIGHT + y - 1, x * GRID_HEIGHT + y);
+
+	// Roots come first in their body, so one forward pass gathers every body
+	uint32_t* bodyOfRoot = FrameArena::allocateArray<uint32_t>(labelCount);
+	waterBodies.clear();
+	for (int chunk = 0; chunk < CHUNKS_X * CHUNKS_Y; ++chunk)
+	{
+		const WaterChunk& waterChunk = waterChunks[chunk];
+		for (int local = 0; local < waterChunk.labelCount; ++local)
 		{
-			fire.setId(MAT_ID_EMPTY);
+			uint32_t label = waterLabelBase[chunk] + local;
+			uint32_t root = findWaterBody(label);
+			if (root == label)
+			{
+				bodyOfRoot[root] = static_cast<uint32_t>(waterBodies.size());
+				waterBodies.emplace_back();
+				waterBodies.back().isSettled = true;
+			}
+			WaterBody& body = waterBodies[bodyOfRoot[root]];
+			body.volume += waterChunk.volume[local];
+			body.surface += waterChunk.surface[local];
+			if (waterChunk.isOpen[local])
+				body.isSettled = false;
 		}
 	}
+
+	waterBodySettled.resize(labelCount);
+	for (uint32_t label = 0; label < labelCount; ++label)
+		waterBodySettled[label] = waterBodies[bodyOfRoot[findWaterBody(label)]].isSettled;
+
+	stats.waterBodies = static_cast<uint32_t>(waterBodies.size());
+	for (const WaterBody& body : waterBodies)
+	{
+		if (body.isSettled)
+			stats.settledWater += body.volume;
+	}
 }
 
+void ParticleWorld::updateCell(float dt, int x, int y)
+{
+	int mat_id = getParticleAt(x, y).getId();
+	if (mat_id == MAT_ID_EMPTY)
+		return;
+
+	stats.cellsVisited++;
+	switch (mat_id)
+	{
+		case MAT_ID_SAND:
+			updateSand(x, y);
+			break;
+		case MAT_ID_WATER:
+			updateWater(x, y);
+			break;
+		case MAT_ID_WOOD:
+			updateWood(dt, x, y);
+			break;
+		case MAT_ID_FIRE:
+			updateFire(dt, x, y);
+			break;
+		case MAT_ID_WOODFIRE:
+			updateWood(dt, x, y);
+			break;
+		case MAT_ID_SMOKE:
+			updateSmoke(dt, x, y);
+			break;
+		default:
+			break;
+	}
+}
 
 void ParticleWorld::update(float dt)
 {
+	PROFILE_SCOPE("ParticleWorld::update");
 	// Update leftward movement timer
 	leftwardMoveTimer += dt;
 	shouldMoveLeftThisFrame = false;
@@ -478,15 +1121,83 @@ void ParticleWorld::update(float dt)
 		leftwardMoveTimer = 0.0f;
 		shouldMoveLeftThisFrame = true;
 	}
-	
-	for (int y = 0; y < GRID_HEIGHT; ++y)
+
+	// Particles that land now are part of this step's grid pass
+	stats = ParticleWorldStats();
+	updateFreeParticles(dt);
+
+	// Clear the per-step flags in storage order, sampling the world state on the way
+	// and noting which reactions each cell has a partner for. Each job takes whole
+	// chunk columns, so the awake flags and masks it writes are its own and only the
+	// counters need merging afterwards; of the cells next door it only reads ids.
+	ParticleWorldStats* columnStats = FrameArena::allocateArray<ParticleWorldStats>(CHUNKS_X);
+	JobSystem::parallelFor(CHUNKS_X, ResetPassChunkColumnsPerJob, [&](uint32_t first, uint32_t last)
 	{
-		for (int x = 0; x < GRID_WIDTH; ++x)
+		for (uint32_t cx = first; cx < last; ++cx)
 		{
-			Particle& p = getParticleAt(x, y);
-			p.setHasBeenUpdated(false);
+			ParticleWorldStats& local = columnStats[cx];
+			local = ParticleWorldStats();
+			uint32_t hashes[CHUNKS_Y];
+			for (int cy = 0; cy < CHUNKS_Y; ++cy)
+			{
+				awakeChunks[cy * CHUNKS_X + cx] = 0;
+				hashes[cy] = ChunkHashSeed;
+			}
+
+			int endX = std::min(GRID_WIDTH, static_cast<int>(cx + 1) * CHUNK_SIZE);
+			for (int x = cx * CHUNK_SIZE; x < endX; ++x)
+			{
+				Particle* column = &particles[x * GRID_HEIGHT];
+				uint16_t* masks = &reactionMasks[x * GRID_HEIGHT];
+				for (int y = 0; y < GRID_HEIGHT; ++y)
+				{
+					Particle& p = column[y];
+					p.setHasBeenUpdated(false);
+
+					int mat_id = p.getId();
+					local.cellsPerMaterial[mat_id]++;
+					uint32_t& hash = hashes[y / CHUNK_SIZE];
+					hash = (hash ^ static_cast<uint32_t>(mat_id)) * ChunkHashPrime;
+					bool burning = mat_id == MAT_ID_FIRE || p.getIsOnFire();
+					if (burning)
+						local.burningCells++;
+
+					// Static wood and stone never change on their own
+					bool dynamic = mat_id == MAT_ID_SAND || mat_id == MAT_ID_WATER || mat_id == MAT_ID_SMOKE || burning;
+					if (dynamic)
+						awakeChunks[(y / CHUNK_SIZE) * CHUNKS_X + cx] = 1;
+
+					uint16_t partners = ReactionTable::getPartnerMask(ReactionTable::reactionId(p));
+					uint16_t neighbours = 0;
+					if (partners != 0)
+					{
+						if (y + 1 < GRID_HEIGHT)
+							neighbours |= 1u << ReactionTable::reactionId(column[y + 1]);
+						if (y > 0)
+							neighbours |= 1u << ReactionTable::reactionId(column[y - 1]);
+						if (x > 0)
+							neighbours |= 1u << ReactionTable::reactionId(column[y - GRID_HEIGHT]);
+						if (x + 1 < GRID_WIDTH)
+							neighbours |= 1u << ReactionTable::reactionId(column[y + GRID_HEIGHT]);
+					}
+					masks[y] = partners & neighbours;
+				}
+			}
+			for (int cy = 0; cy < CHUNKS_Y; ++cy)
+				waterChunks[cy * CHUNKS_X + cx].pendingHash = hashes[cy];
 		}
+	});
+	for (int cx = 0; cx < CHUNKS_X; ++cx)
+	{
+		stats.burningCells += columnStats[cx].burningCells;
+		for (int mat_id = 0; mat_id < MAT_ID_COUNT; ++mat_id)
+			stats.cellsPerMaterial[mat_id] += columnStats[cx].cellsPerMaterial[mat_id];
 	}
+	for (uint8_t awake : awakeChunks)
+		stats.awakeChunks += awake;
+
+	updateWaterBodies();
+	updateReactions();
 
 	frame_count++;
 	for (int y = GRID_HEIGHT - 1; y > 0; --y)
@@ -494,138 +1205,88 @@ void ParticleWorld::update(float dt)
 		if (frame_count % 2 == 0)
 		{
 			for (int x = 0; x < GRID_WIDTH; ++x)
-			{
-				int mat_id = getParticleAt(x, y).getId();
-				switch (mat_id)
-				{
-					case MAT_ID_EMPTY:
-						break;
-					case MAT_ID_SAND:
-						updateSand(x, y);
-						break;
-					case MAT_ID_WATER:
-						updateWater(x, y);
-						break;
-					case MAT_ID_WOOD:
-						updateWood(dt, x, y);
-						break;
-					case MAT_ID_FIRE:
-						updateFire(dt, x, y);
-						break;
-					case MAT_ID_WOODFIRE:
-						updateWood(dt, x, y);
-						break;
-					default:
-						break;}
-			}
+				updateCell(dt, x, y);
 		}
 		else
 		{
 			for (int x = GRID_WIDTH - 1; x >= 0; --x)
-			{
-				int mat_id = getParticleAt(x, y).getId();
-				switch (mat_id)
-				{
-					case MAT_ID_EMPTY:
-						break;
-					case MAT_ID_SAND:
-						updateSand(x, y);
-						break;
-					case MAT_ID_WATER:
-						updateWater(x, y);
-						break;
-					case MAT_ID_WOOD:
-						updateWood(dt, x, y);
-						break;
-					case MAT_ID_FIRE:
-						updateFire(dt, x, y);
-						break;
-					case MAT_ID_WOODFIRE:
-						updateWood(dt, x, y);
-						break;
-					default:
-						break;
-				}
-			}
+				updateCell(dt, x, y);
 		}
 	}
 }
 
-void ParticleWorld::render(sf::RenderTarget &target)
+void ParticleWorld::buildVertices(sf::VertexArray &vertices)
 {
-	for (int y = GRID_HEIGHT - 1; y > 0; --y)
+	PROFILE_SCOPE("ParticleWorld::buildVertices");
+
+	const bool flicker = settings.fireFlicker;
+	auto fireColor = [flicker]()
 	{
-		for (int x = 0; x < GRID_WIDTH; ++x)
+		if (!flicker)
+			return sf::Color(255, 140, 0);
+		// Not the world's generator, so drawing a frame never changes what the simulation does
+		return (rand() % 2 == 0) ? sf::Color::Yellow : sf::Color::Red;
+	};
+
+	auto cellColor = [&fireColor](const Particle& p, sf::Color& color)
+	{
+		switch (p.getId())
 		{
-			int mat_id = getParticleAt(x, y).getId();
-			switch (mat_id)
-			{
-				case MAT_ID_EMPTY:
-					break;
-				case MAT_ID_SAND:
-				{
-					sf::RectangleShape rectangle(sf::Vector2f(1.f * ParticleScale, 1.f * ParticleScale));
-					rectangle.setPosition({static_cast<float>(x) * ParticleScale, static_cast<float>(y) * ParticleScale});
-					rectangle.setFillColor(sf::Color(194, 178, 128)); // Beige/tan sand color
-					target.draw(rectangle);
-					break;
-				}
-				case MAT_ID_WATER:
-				{
-					sf::RectangleShape rectangle(sf::Vector2f(1.f * ParticleScale, 1.f * ParticleScale));
-					rectangle.setPosition({static_cast<float>(x) * ParticleScale, static_cast<float>(y) * ParticleScale});
-					rectangle.setFillColor(sf::Color(0, 105, 148)); // Ocean blue
-					target.draw(rectangle);
-					break;
-				}
-				case MAT_ID_WOOD:
-				{
-					sf::RectangleShape rectangle(sf::Vector2f(1.f * ParticleScale, 1.f * ParticleScale));
-					rectangle.setPosition({static_cast<float>(x) * ParticleScale, static_cast<float>(y) * ParticleScale});
-					
-					// Check if this wood particle is on fire
-					Particle& p = getParticleAt(x, y);
-					if (p.getIsOnFire())
-					{
-						// Render as burning wood with fire colors
-						if (rand() % 2 == 0)
-							rectangle.setFillColor(sf::Color::Yellow);
-						else
-							rectangle.setFillColor(sf::Color::Red);
-					}
-					else
-					{
-						rectangle.setFillColor(sf::Color(70, 50, 30)); // Dark Brown color
-					}
-					
-					target.draw(rectangle);
-					break;
-				}
-				case MAT_ID_FIRE:
-				{
-					sf::RectangleShape rectangle(sf::Vector2f(1.f * ParticleScale, 1.f * ParticleScale));
-					rectangle.setPosition({static_cast<float>(x) * ParticleScale, static_cast<float>(y) * ParticleScale});
-					if (rand() % 2 == 0)
-						rectangle.setFillColor(sf::Color::Yellow); // Yellow color
-					else
-						rectangle.setFillColor(sf::Color::Red); // Red color
-					target.draw(rectangle);
-					break;
-				}
-				case MAT_ID_WOODFIRE:
-				{
-					sf::RectangleShape rectangle(sf::Vector2f(1.f * ParticleScale, 1.f * ParticleScale));
-					rectangle.setPosition({static_cast<float>(x) * ParticleScale, static_cast<float>(y) * ParticleScale});
-					if (rand() % 2 == 0)
-						rectangle.setFillColor(sf::Color::Yellow); // Yellow color
-					else
-						rectangle.setFillColor(sf::Color::Red); // Red color
-					target.draw(rectangle);
-					break;
-				}
-				default:
-					break;
-			}
+			case MAT_ID_SAND:
+				color = sf::Color(194, 178, 128); // Beige/tan sand color
+				return true;
+			case MAT_ID_WATER:
+				color = sf::Color(0, 105, 148); // Ocean blue
+				return true;
+			case MAT_ID_WOOD:
+				// Burning wood flickers with fire colors
+				if (p.getIsOnFire())
+					color = fireColor();
+				else
+					color = sf::Color(70, 50, 30); // Dark Brown color
+				return true;
+			case MAT_ID_FIRE:
+			case MAT_ID_WOODFIRE:
+				color = fireColor();
+				return true;
+			case MAT_ID_SMOKE:
+				color = sf::Color(110, 110, 110);
+				return true;
+			default:
+				return false;
 		}
+	};
+	auto appendQuad = [&vertices](float left, float top, sf::Color color)
+	{
+		float right = left + ParticleScale;
+		float bottom = top + ParticleScale;
+		vertices.append({{left, top}, color});
+		vertices.append({{right, top}, color});
+		vertices.append({{left, bottom}, color});
+		vertices.append({{left, bottom}, color});
+		vertices.append({{right, top}, color});
+		vertices.append({{right, bottom}, color});
+	};
+
+	// Every visible cell becomes one quad in a single vertex array; the array keeps
+	// its capacity, so after warm-up this neither allocates nor issues per-cell draws
+	vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+	vertices.clear();
+	sf::Color color;
+	for (int x = 0; x < GRID_WIDTH; ++x)
+	{
+		const Particle* column = &particles[x * GRID_HEIGHT];
+		for (int y = 1; y < GRID_HEIGHT; ++y)
+		{
+			if (cellColor(column[y], color))
+				appendQuad(static_cast<float>(x) * ParticleScale, static_cast<float>(y) * ParticleScale, color);
+		}
+	}
+
+	// Free particles are drawn where they are, off the grid
+	for (size_t i = 0; i < freeParticles.size(); ++i)
+	{
+		if (cellColor(freeParticles.cells[i], color))
+			appendQuad((freeParticles.x[i] - 0.5f) * ParticleScale, (freeParticles.y[i] - 0.5f) * ParticleScale, color);
 	}
 }
@@ -1,21 +1,100 @@
 #pragma once
 
 #include "Particle.h"
+#include "core/Random.h"
+#include <cstdint>
 #include <vector>
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 
-namespace sf { class RenderTarget; }
+// Counters for the last update step
+struct ParticleWorldStats
+{
+	uint32_t	cellsVisited = 0;	// Non-empty cells handed to a material update
+	uint32_t	swaps = 0;
+	uint32_t	burningCells = 0;
+	uint32_t	awakeChunks = 0;	// Chunks holding at least one cell that can change on its own
+	uint32_t	freeParticles = 0;	// Cells in flight outside the grid
+	uint32_t	landedParticles = 0;	// Free particles put back into the grid this step
+	uint32_t	reactions = 0;
+	uint32_t	waterBodies = 0;		// Connected bodies of water, across chunks
+	uint32_t	settledWater = 0;		// Water cells in bodies with nowhere left to flow
+	uint32_t	skippedWater = 0;		// Settled interior cells the step did not visit
+	uint32_t	relabeledChunks = 0;	// Chunks whose water was labelled again this step
+	uint32_t	cellsPerMaterial[MAT_ID_COUNT] = {};
+};
+
+// Work the world can shed under load; the defaults are full quality
+struct ParticleWorldSettings
+{
+	int			maxDispersity = 4;				// Cap on how far water searches sideways per step
+	bool		singleReactionRoll = false;		// Chance reactions roll for one random neighbour instead of all four
+	bool		fireFlicker = true;				// Random per-cell fire colours; a flat colour otherwise
+};
+
+// Cells knocked out of the grid, flying ballistically until they hit something.
+// Kept as separate arrays so integrating them is a plain loop over floats the
+// compiler vectorizes; the cell itself only comes back out when it lands.
+struct FreeParticleBuffer
+{
+	std::vector<float>		x, y;			// Cell units, continuous
+	std::vector<float>		previousX, previousY;	// Where the last step started; landing traces from here
+	std::vector<float>		velocityX, velocityY;	// Cells per second
+	std::vector<Particle>	cells;
+
+	size_t size() const { return cells.size(); }
+	void push(float px, float py, float vx, float vy, const Particle& cell);
+	void removeAt(size_t i);	// Swaps the last one in; order does not matter
+	void clear();
+};
+
+// A connected body of water as of the last update step
+struct WaterBody
+{
+	uint32_t	volume = 0;		// Cells
+	uint32_t	surface = 0;	// Cells with air directly above
+	bool		isSettled = false;	// No cell of it can move; its interior is not simulated
+};
 
 class ParticleWorld 
 {
 	public:
+		static constexpr int CHUNK_SIZE = 16;
+		static constexpr size_t MaxFreeParticles = 8192;	// Past this, impulses leave cells in the grid
+
 	    ParticleWorld();
 	    ~ParticleWorld() {};
 
+		// Empties the grid and restarts the step counters and timers without reallocating
+		void reset();
+		// The simulation draws its random choices from the world, not rand(), so a world
+		// replays the same from the same seed and cells, and worlds on different
+		// threads do not share a generator. reset() goes back to the seed.
+		void setSeed(uint32_t seed);
+
 		Particle &getParticleAt(int x, int y);
 		ParticleWorld& getParticleWorld() { return *this; }
 
 		void addParticle(const sf::Vector2f& position, sf::Vector2f velocity, int mat_id);
+		void addParticles(const sf::Vector2f* positions, size_t count, int mat_id);
+
+		// Batched editing. Shapes are in window pixels, clipped to the grid once per
+		// shape and written as contiguous column spans; a cell is covered when its
+		// centre is inside the shape.
+		void fillRect(const sf::Vector2f& position, const sf::Vector2f& size, int mat_id);
+		void fillCircle(const sf::Vector2f& center, float radius, int mat_id);
+		void scatterCircle(const sf::Vector2f& center, float radius, float density, int mat_id);
+		void drawLine(const sf::Vector2f& from, const sf::Vector2f& to, int mat_id);
+
+		// Reacts a reagent that is not a cell, e.g. a projectile, with the cell at (x, y)
+		// through the reaction table. Returns whether anything happened.
+		bool applyReagent(int x, int y, int reagent);
+
+		// Throws the loose cells (sand, water, fire) within radius of center out of the
+		// grid. velocity is in pixels per second and fades to nothing at the edge.
+		// Returns how many cells left the grid.
+		size_t applyImpulse(const sf::Vector2f& center, float radius, const sf::Vector2f& velocity);
+		size_t getFreeParticleCount() const { return freeParticles.size(); }
 
 		void updateSand(int x, int y);
 		void updateWater(int x, int y);
@@ -24,13 +103,74 @@ class ParticleWorld
 		void updateSmoke(float dt, int x, int y);
 
 	    void update(float deltaTime);
-	    void render(sf::RenderTarget &target);
+		// Writes the world's triangles; lets another thread prepare a frame
+		void buildVertices(sf::VertexArray &vertices);
+
+		// Raw cell storage, column-major, for saving and restoring whole worlds. Cells in
+		// flight are not part of it, and setCells() drops them.
+		const Particle* getCells() const { return particles.data(); }
+		size_t getCellCount() const { return particles.size(); }
+		void setCells(const Particle* cells);
+
+		const std::vector<WaterBody>& getWaterBodies() const { return waterBodies; }
+
+		const ParticleWorldStats& getStats() const { return stats; }
+		void setSettings(const ParticleWorldSettings& newSettings) { settings = newSettings; }
+		const ParticleWorldSettings& getSettings() const { return settings; }
 
 	  private:
-		std::vector<std::vector<Particle>>	particles;
+		static constexpr int MaxWaterLabels = CHUNK_SIZE * CHUNK_SIZE / 2;	// A checkerboard is the worst case
+
+		// Water components inside one chunk. A chunk is labelled again only when its
+		// cells or those around it changed, which the reset pass spots by hashing ids.
+		struct WaterChunk
+		{
+			uint32_t	hash = 0;
+			uint32_t	pendingHash = 0;	// From this step's reset pass
+			int			labelCount = 0;
+			uint16_t	volume[MaxWaterLabels];
+			uint16_t	surface[MaxWaterLabels];
+			uint8_t		isOpen[MaxWaterLabels];		// Some cell can still flow somewhere
+		};
+
+		std::vector<Particle>				particles;  // Column-major, GRID_HEIGHT cells per column
+		FreeParticleBuffer					freeParticles;
+		std::vector<uint8_t>				dirtyChunks;	// Edited since the water labels last looked
+		std::vector<uint8_t>				awakeChunks;
+		std::vector<uint16_t>				reactionMasks;	// Per cell: the materials around it that it reacts with
+		std::vector<WaterChunk>				waterChunks;
+		std::vector<uint8_t>				waterLabels;	// Per cell: 1-based label within its chunk, 0 if not water
+		std::vector<uint8_t>				waterInterior;	// Per cell: water on all four sides
+		std::vector<uint32_t>				waterBodyParents;	// Union-find over every chunk's labels
+		std::vector<uint32_t>				waterLabelBase;	// Per chunk: index of its first label in the above
+		std::vector<uint8_t>				waterBodySettled;	// Per label, copied from its body
+		std::vector<WaterBody>				waterBodies;
+		int									waterLabelDispersity = -1;	// maxDispersity the labels were taken with
+		ParticleWorldStats					stats;
+		ParticleWorldSettings				settings;
+		uint32_t							randomSeed = Random::DefaultSeed;
+		Random								random;		// Every random choice the simulation makes
 		int									frame_count = 0;
-		sf::Vector2f						gravity = {0.f, 1.f};  // Positive = downward
+		sf::Vector2f						gravity = {0.f, 120.f};  // Cells per second squared on free particles; positive = downward
 		float								leftwardMoveTimer = 0.0f;
 		float								leftwardMoveInterval = 0.02f; // Move left every 0.02 seconds
 		bool								shouldMoveLeftThisFrame = false;
+
+		void updateCell(float dt, int x, int y);
+		void updateReactions();
+		void updateWaterBodies();
+		void labelWaterChunk(int cx, int cy);
+		bool canWaterFlowFrom(int x, int y) const;
+		uint32_t findWaterBody(uint32_t label);
+		bool isSettledWaterInterior(int x, int y) const;
+		void reactCell(int x, int y);
+		void setReactionProduct(Particle& cell, uint8_t product, float heat);
+		void updateFreeParticles(float dt);
+		bool landFreeParticle(size_t i);
+		void swapParticles(Particle& a, Particle& b);
+		void markChunksDirty(int minX, int minY, int maxX, int maxY);
+		uint32_t nextRandom() { return random.next(); }
+		float nextRandomFloat() { return random.nextFloat(); }
+		void fillColumnSpan(int x, int y0, int y1, const Particle& prototype);
+		void scatterColumnSpan(int x, int y0, int y1, const Particle& prototype, uint32_t threshold);
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "ParticleWorldBatch.h"
+#include "core/FrameArena.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+
+ParticleWorldBatch::ParticleWorldBatch(size_t worldCount, uint32_t firstSeed)
+{
+	worlds.reserve(worldCount);
+	for (size_t i = 0; i < worldCount; ++i)
+	{
+		worlds.push_back(std::make_unique<ParticleWorld>());
+		worlds.back()->setSeed(firstSeed + static_cast<uint32_t>(i));
+	}
+}
+
+void ParticleWorldBatch::reset()
+{
+	for (std::unique_ptr<ParticleWorld>& world : worlds)
+		world->reset();
+	totalStats = ParticleWorldStats();
+	stepCount = 0;
+}
+
+void ParticleWorldBatch::step(float dt, const WorldFunction& beforeUpdate)
+{
+	PROFILE_SCOPE("ParticleWorldBatch::step");
+	JobSystem::parallelFor(static_cast<uint32_t>(worlds.size()), 1, [&](uint32_t first, uint32_t last)
+	{
+		for (uint32_t i = first; i < last; ++i)
+		{
+			// The job may run on a thread in the middle of something else, so it
+			// hands back only what this world's step took from the arena
+			FrameArena::Scope arenaScope;
+			ParticleWorld& world = *worlds[i];
+			if (beforeUpdate)
+				beforeUpdate(i, world);
+			world.update(dt);
+		}
+	});
+	stepCount++;
+
+	totalStats = ParticleWorldStats();
+	for (const std::unique_ptr<ParticleWorld>& world : worlds)
+	{
+		const ParticleWorldStats& stats = world->getStats();
+		totalStats.cellsVisited += stats.cellsVisited;
+		totalStats.swaps += stats.swaps;
+		totalStats.burningCells += stats.burningCells;
+		totalStats.awakeChunks += stats.awakeChunks;
+		totalStats.freeParticles += stats.freeParticles;
+		totalStats.landedParticles += stats.landedParticles;
+		totalStats.reactions += stats.reactions;
+		totalStats.waterBodies += stats.waterBodies;
+		totalStats.settledWater += stats.settledWater;
+		totalStats.skippedWater += stats.skippedWater;
+		totalStats.relabeledChunks += stats.relabeledChunks;
+		for (int mat_id = 0; mat_id < MAT_ID_COUNT; ++mat_id)
+			totalStats.cellsPerMaterial[mat_id] += stats.cellsPerMaterial[mat_id];
+	}
+}
+
+void ParticleWorldBatch::run(uint32_t steps, float dt, const WorldFunction& beforeUpdate)
+{
+	for (uint32_t i = 0; i < steps; ++i)
+		step(dt, beforeUpdate);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ParticleWorld.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Many independent worlds of the same size stepped in lockstep, for offline runs
+// such as balancing spawn rates and material mixes where nothing is drawn. Each
+// world is one job per step, so a batch fills every core of the JobSystem, which
+// the caller initializes. A world's own step stays sequential: cells move as they
+// are visited, so lanes across worlds would diverge on the first branch.
+class ParticleWorldBatch
+{
+	public:
+		// Runs inside the world's job, before its update; e.g. emitters spawning into it
+		using WorldFunction = std::function<void(size_t index, ParticleWorld& world)>;
+
+		// World i is seeded firstSeed + i, so a batch replays the same from the same seeds
+		explicit ParticleWorldBatch(size_t worldCount, uint32_t firstSeed = 1);
+
+		// Every world back to empty and its seed
+		void reset();
+
+		void step(float dt, const WorldFunction& beforeUpdate = nullptr);
+		void run(uint32_t steps, float dt, const WorldFunction& beforeUpdate = nullptr);
+
+		size_t getWorldCount() const { return worlds.size(); }
+		ParticleWorld& getWorld(size_t index) { return *worlds[index]; }
+		const ParticleWorld& getWorld(size_t index) const { return *worlds[index]; }
+
+		// Every world's counters for the last step added together
+		const ParticleWorldStats& getTotalStats() const { return totalStats; }
+		uint64_t getStepCount() const { return stepCount; }
+
+	private:
+		std::vector<std::unique_ptr<ParticleWorld>>	worlds;		// Apart, so worlds on different cores share no cache lines
+		ParticleWorldStats							totalStats;
+		uint64_t									stepCount = 0;
+};
@@ -0,0 +1,37 @@
+#include "Reactions.h"
+
+namespace
+{
+	struct ReactionEntry
+	{
+		int			a;
+		int			b;
+		Reaction	reaction;
+	};
+
+	// Every interaction between materials lives here. Entries are one-sided: A
+	// reacts when it finds B next to it, so a symmetric pair needs both.
+	const ReactionEntry ReactionEntries[] =
+	{
+		// A                       B                 product A        product B       probability  heat
+		{MAT_ID_WATER,             MAT_ID_FIRE,      {REACTION_KEEP,  MAT_ID_SMOKE,   1.0f,        0.0f}},
+		{MAT_ID_FIRE,              MAT_ID_WATER,     {MAT_ID_SMOKE,   REACTION_KEEP,  1.0f,        0.0f}},
+		{MAT_ID_FIRE,              MAT_ID_WOOD,      {MAT_ID_EMPTY,   REACTION_KEEP,  1.0f,        1.0f}},
+		{MAT_ID_FIRE,              MAT_ID_OIL,       {MAT_ID_EMPTY,   REACTION_KEEP,  1.0f,        1.0f}},
+		{MAT_ID_WOODFIRE,          MAT_ID_WOOD,      {REACTION_KEEP,  REACTION_KEEP,  0.125f,      1.0f}},
+		{REAGENT_FIRE_PROJECTILE,  MAT_ID_WOOD,      {REACTION_KEEP,  REACTION_KEEP,  1.0f,        1.0f}},
+		{REAGENT_ICE_PROJECTILE,   MAT_ID_WOOD,      {REACTION_KEEP,  MAT_ID_EMPTY,   1.0f,        0.0f}},
+		{REAGENT_ICE_PROJECTILE,   MAT_ID_WOODFIRE,  {REACTION_KEEP,  MAT_ID_EMPTY,   1.0f,        0.0f}},
+	};
+}
+
+const ReactionTable::Matrix ReactionTable::s_matrix;
+
+ReactionTable::Matrix::Matrix()
+{
+	for (const ReactionEntry& entry : ReactionEntries)
+	{
+		reactions[entry.a][entry.b] = entry.reaction;
+		partnerMasks[entry.a] |= static_cast<uint16_t>(1u << entry.b);
+	}
+}
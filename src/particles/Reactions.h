@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Particle.h"
+#include <cstdint>
+
+// Reaction rows past the materials, for things that touch the grid without
+// being cells, like projectiles
+enum ReagentID
+{
+	REAGENT_FIRE_PROJECTILE = MAT_ID_COUNT,
+	REAGENT_ICE_PROJECTILE,
+	REAGENT_COUNT
+};
+
+// A product that leaves its cell as it is
+const uint8_t REACTION_KEEP = 0xFF;
+
+// What happens when a cell of one material (A) sits next to one of another (B)
+struct Reaction
+{
+	uint8_t		productA = REACTION_KEEP;
+	uint8_t		productB = REACTION_KEEP;
+	float		probability = 0.0f;		// Per neighbour per step
+	float		heat = 0.0f;			// Above zero sets flammable products alight, below zero puts them out
+};
+
+// The material x material reaction matrix. Burning flammable cells react as
+// MAT_ID_WOODFIRE, so fire spreading is an entry like any other. Each row also
+// keeps a mask of the materials it reacts with, so a cell can rule out every
+// reaction with one AND against the materials around it.
+class ReactionTable
+{
+public:
+	static int reactionId(const Particle& particle)
+	{
+		return particle.getIsOnFire() ? MAT_ID_WOODFIRE : particle.getId();
+	}
+
+	static const Reaction& get(int a, int b) { return s_matrix.reactions[a][b]; }
+	static uint16_t getPartnerMask(int a) { return s_matrix.partnerMasks[a]; }
+
+private:
+	struct Matrix
+	{
+		Reaction	reactions[REAGENT_COUNT][MAT_ID_COUNT];
+		uint16_t	partnerMasks[REAGENT_COUNT] = {};
+
+		Matrix();
+	};
+
+	static const Matrix s_matrix;
+};
@@ -0,0 +1,107 @@
+#include "Hud.h"
+#include "core/Profiler.h"
+#include <cstdio>
+#include <SFML/Graphics/RenderTarget.hpp>
+
+HudText::HudText(const sf::Font& font, unsigned int characterSize)
+    : m_text(font, "", characterSize)
+{
+}
+
+void HudText::setPlacement(const sf::Vector2f& relativePosition, const sf::Vector2f& offset, const sf::Vector2f& anchor)
+{
+    m_relativePosition = relativePosition;
+    m_offset = offset;
+    m_anchor = anchor;
+    m_isLayoutDirty = true;
+}
+
+void HudText::setStyle(uint32_t style)
+{
+    m_text.setStyle(style);
+    m_isLayoutDirty = true;
+}
+
+void HudText::setString(const std::string& string)
+{
+    if (m_numberPrefix == nullptr && string == m_string)
+        return;
+
+    m_numberPrefix = nullptr;
+    m_string = string;
+    m_text.setString(m_string);
+    m_isLayoutDirty = true;
+}
+
+void HudText::setNumber(const char* prefix, long long value)
+{
+    if (m_numberPrefix == prefix && m_number == value)
+        return;
+
+    m_numberPrefix = prefix;
+    m_number = value;
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%s%lld", prefix, value);
+    m_text.setString(buffer);
+    m_isLayoutDirty = true;
+}
+
+void HudText::layout(const sf::Vector2f& targetSize)
+{
+    sf::FloatRect bounds = m_text.getLocalBounds();
+    m_text.setOrigin({bounds.size.x * m_anchor.x, bounds.size.y * m_anchor.y});
+    m_text.setPosition({targetSize.x * m_relativePosition.x + m_offset.x,
+                        targetSize.y * m_relativePosition.y + m_offset.y});
+    m_isLayoutDirty = false;
+}
+
+Hud::Hud()
+    : m_panels(sf::PrimitiveType::Triangles)
+{
+}
+
+HudText& Hud::addText(const sf::Font& font, unsigned int characterSize)
+{
+    m_texts.push_back(std::make_unique<HudText>(font, characterSize));
+    return *m_texts.back();
+}
+
+void Hud::addPanel(const sf::Vector2f& position, const sf::Vector2f& size, const sf::Color& color)
+{
+    sf::Vector2f topRight(position.x + size.x, position.y);
+    sf::Vector2f bottomLeft(position.x, position.y + size.y);
+    sf::Vector2f bottomRight = position + size;
+    m_panels.append({position, color});
+    m_panels.append({topRight, color});
+    m_panels.append({bottomLeft, color});
+    m_panels.append({bottomLeft, color});
+    m_panels.append({topRight, color});
+    m_panels.append({bottomRight, color});
+}
+
+void Hud::render(sf::RenderTarget& target)
+{
+    PROFILE_SCOPE("Hud::render");
+    sf::Vector2u targetSize = target.getSize();
+    bool isResized = targetSize != m_targetSize;
+    m_targetSize = targetSize;
+
+    if (m_panels.getVertexCount() > 0)
+        target.draw(m_panels);
+
+    sf::Vector2f size(static_cast<float>(targetSize.x), static_cast<float>(targetSize.y));
+    for (const std::unique_ptr<HudText>& pText : m_texts)
+    {
+        if (!pText->m_isVisible)
+            continue;
+        if (pText->m_isLayoutDirty || isResized)
+            pText->layout(size);
+        target.draw(pText->m_text);
+    }
+
+    for (HudOverlay* pOverlay : m_overlays)
+    {
+        if (pOverlay->isVisible())
+            pOverlay->render(target);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+namespace sf { class Font; class RenderTarget; }
+
+// One line or block of HUD text. The laid-out sf::Text is kept between frames
+// and only reflowed when the bound string or number actually changes.
+class HudText
+{
+public:
+    HudText(const sf::Font& font, unsigned int characterSize);
+
+    // Placement is the target size times relativePosition plus offset, so centred
+    // and corner-anchored text follows window size changes; anchor is the point of
+    // the text's own bounds that lands there, (0.5, 0.5) for centred.
+    void setPlacement(const sf::Vector2f& relativePosition, const sf::Vector2f& offset,
+                      const sf::Vector2f& anchor = {0.0f, 0.0f});
+    void setColor(const sf::Color& color) { m_text.setFillColor(color); }
+    void setStyle(uint32_t style);
+    void setVisible(bool visible) { m_isVisible = visible; }
+    bool isVisible() const { return m_isVisible; }
+
+    // No-ops when the value is the one already shown
+    void setString(const std::string& string);
+    void setNumber(const char* prefix, long long value);
+
+private:
+    friend class Hud;
+
+    sf::Text m_text;
+    std::string m_string;
+    const char* m_numberPrefix = nullptr;
+    long long m_number = 0;
+    sf::Vector2f m_relativePosition;
+    sf::Vector2f m_offset;
+    sf::Vector2f m_anchor;
+    bool m_isVisible = true;
+    bool m_isLayoutDirty = true;
+
+    void layout(const sf::Vector2f& targetSize);
+};
+
+// Debug panels drawn on top of everything else; the HUD decides when, the
+// overlay decides what
+class HudOverlay
+{
+public:
+    virtual ~HudOverlay() = default;
+    virtual bool isVisible() const { return true; }
+    virtual void render(sf::RenderTarget& target) = 0;
+};
+
+// Retained screen-space layer. Widgets are created once and updated through
+// their setters; render() re-lays out only what changed, draws every panel in
+// a single call, then one call per visible text, then the overlays.
+class Hud
+{
+public:
+    Hud();
+
+    HudText& addText(const sf::Font& font, unsigned int characterSize);
+    void addPanel(const sf::Vector2f& position, const sf::Vector2f& size, const sf::Color& color);
+    void addOverlay(HudOverlay* pOverlay) { m_overlays.push_back(pOverlay); }
+
+    void render(sf::RenderTarget& target);
+
+private:
+    std::vector<std::unique_ptr<HudText>> m_texts;
+    std::vector<HudOverlay*> m_overlays;
+    sf::VertexArray m_panels;
+    sf::Vector2u m_targetSize;
+};
@@ -0,0 +1,141 @@
+#include "ProfilerOverlay.h"
+#include "core/AllocationTracker.h"
+#include "core/FrameGovernor.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+#include "core/Telemetry.h"
+#include "ResourceManager.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Text.hpp>
+
+namespace
+{
+    const sf::Vector2f PanelPosition = {10.0f, 50.0f};
+    const sf::Vector2f PanelSize = {300.0f, 260.0f};
+    const float GraphHeight = 60.0f;
+    const float GraphScaleMs = 33.3f;   // Frame time at the top of the graph
+}
+
+ProfilerOverlay::ProfilerOverlay()
+    : m_graph(sf::PrimitiveType::LineStrip, Profiler::HistorySize)
+    , m_budgetLine(sf::PrimitiveType::Lines, 2)
+{
+}
+
+ProfilerOverlay::~ProfilerOverlay() = default;
+
+bool ProfilerOverlay::init()
+{
+    const sf::Font* pFont = ResourceManager::getOrLoadFont("Lavigne.ttf");
+    if (pFont == nullptr)
+        return false;
+
+    m_pText = std::make_unique<sf::Text>(*pFont);
+    m_pText->setCharacterSize(14);
+    m_pText->setFillColor(sf::Color::White);
+    m_pText->setPosition({PanelPosition.x + 6.0f, PanelPosition.y + 4.0f});
+
+    m_background.setSize(PanelSize);
+    m_background.setPosition(PanelPosition);
+    m_background.setFillColor(sf::Color(0, 0, 0, 170));
+
+    float graphBottom = PanelPosition.y + PanelSize.y - 6.0f;
+    float budgetY = graphBottom - GraphHeight * (FrameBudgetMs / GraphScaleMs);
+    m_budgetLine[0] = {{PanelPosition.x + 6.0f, budgetY}, sf::Color::Red};
+    m_budgetLine[1] = {{PanelPosition.x + PanelSize.x - 6.0f, budgetY}, sf::Color::Red};
+    return true;
+}
+
+void ProfilerOverlay::startTextRefresh()
+{
+    m_quality = static_cast<int>(FrameGovernor::getLevel());
+    m_costMs = FrameGovernor::getSmoothedCostMs();
+    m_budgetMs = FrameGovernor::getBudgetMs();
+    m_isStrict = AllocationTracker::isStrict();
+
+    Job job;
+    job.function = &ProfilerOverlay::formatText;
+    job.context = this;
+    JobSystem::submit(job, JobSystem::getFrameCounter());
+}
+
+void ProfilerOverlay::formatText(const Job& job)
+{
+    PROFILE_SCOPE("ProfilerOverlay::formatText");
+    ProfilerOverlay* pOverlay = static_cast<ProfilerOverlay*>(job.context);
+    const float* frameHistory = Profiler::getFrameHistoryMs();
+    float frameSum = 0.0f;
+    for (size_t i = 0; i < Profiler::HistorySize; ++i)
+        frameSum += frameHistory[i];
+
+    char line[96];
+    std::snprintf(line, sizeof(line), "frame %6.2f ms%s\n", frameSum / Profiler::HistorySize,
+                  Profiler::isCapturing() ? "  [capturing]" : "");
+    std::string& text = pOverlay->m_pendingText;
+    text = line;
+    std::snprintf(line, sizeof(line), "p50 %.1f  p95 %.1f  p99 %.1f ms%s\n",
+                  Telemetry::getFrameTimePercentile(50.0f), Telemetry::getFrameTimePercentile(95.0f),
+                  Telemetry::getFrameTimePercentile(99.0f), Telemetry::isRecording() ? "  [telemetry]" : "");
+    text += line;
+    const AllocationFrameCounts& allocations = AllocationTracker::getLastFrame();
+    std::snprintf(line, sizeof(line), "heap %llu allocs %llu bytes%s\n",
+                  static_cast<unsigned long long>(allocations.allocations),
+                  static_cast<unsigned long long>(allocations.bytes),
+                  pOverlay->m_isStrict ? "  [strict]" : "");
+    text += line;
+    std::snprintf(line, sizeof(line), "quality %d  cost %.2f / %.1f ms\n", pOverlay->m_quality,
+                  pOverlay->m_costMs, pOverlay->m_budgetMs);
+    text += line;
+    const JobStats& jobs = JobSystem::getLastFrameStats();
+    std::snprintf(line, sizeof(line), "jobs %llu  stolen %llu  busy %.2f ms\n",
+                  static_cast<unsigned long long>(jobs.jobsRun), static_cast<unsigned long long>(jobs.jobsStolen),
+                  jobs.busyNs / 1.0e6);
+    text += line;
+    for (const Profiler::ZoneStats& zone : Profiler::getZoneStats())
+    {
+        std::snprintf(line, sizeof(line), "%-22.22s %6.2f %6.2f\n", zone.name, zone.averageMs, zone.maxMs);
+        text += line;
+    }
+    pOverlay->m_hasPendingText = true;
+}
+
+void ProfilerOverlay::render(sf::RenderTarget& target)
+{
+    if (!m_pText)
+        return;
+
+    if (m_hasPendingText)
+    {
+        m_pText->setString(m_pendingText);
+        m_hasPendingText = false;
+    }
+    // Rebuilding the text reflows every glyph, so only do it a few times a second
+    if (--m_framesUntilTextRefresh <= 0)
+    {
+        startTextRefresh();
+        m_framesUntilTextRefresh = TextRefreshFrames;
+    }
+
+    // Oldest sample on the left, newest on the right
+    const float* frameHistory = Profiler::getFrameHistoryMs();
+    size_t cursor = Profiler::getHistoryCursor();
+    float graphLeft = PanelPosition.x + 6.0f;
+    float graphBottom = PanelPosition.y + PanelSize.y - 6.0f;
+    float step = (PanelSize.x - 12.0f) / (Profiler::HistorySize - 1);
+    for (size_t i = 0; i < Profiler::HistorySize; ++i)
+    {
+        float ms = frameHistory[(cursor + 1 + i) % Profiler::HistorySize];
+        float height = GraphHeight * std::min(ms / GraphScaleMs, 1.0f);
+        m_graph[i].position = {graphLeft + step * i, graphBottom - height};
+        m_graph[i].color = ms > FrameBudgetMs ? sf::Color::Red : sf::Color::Green;
+    }
+
+    target.draw(m_background);
+    target.draw(*m_pText);
+    target.draw(m_budgetLine);
+    target.draw(m_graph);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Hud.h"
+#include "core/Profiler.h"
+#include <memory>
+#include <string>
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+namespace sf { class RenderTarget; class Text; }
+struct Job;
+
+// Draws the profiler's rolling zone timings and a frame-time graph on top of the game
+class ProfilerOverlay : public HudOverlay
+{
+public:
+    ProfilerOverlay();
+    ~ProfilerOverlay();
+
+    bool init();
+    bool isVisible() const override { return Profiler::isOverlayVisible(); }
+    void render(sf::RenderTarget& target) override;
+
+private:
+    static constexpr int TextRefreshFrames = 15;
+
+    std::unique_ptr<sf::Text> m_pText;
+    sf::RectangleShape m_background;
+    sf::VertexArray m_graph;
+    sf::VertexArray m_budgetLine;
+    int m_framesUntilTextRefresh = 0;
+
+    // The text is formatted by a frame job and handed to m_pText by the next render.
+    // Values that are per thread, or change before the frame ends, are read up front.
+    std::string m_pendingText;
+    bool m_hasPendingText = false;
+    int m_quality = 0;
+    float m_costMs = 0.0f;
+    float m_budgetMs = 0.0f;
+    bool m_isStrict = false;
+
+    void startTextRefresh();
+    static void formatText(const Job& job);
+};
@@ -0,0 +1,157 @@
+// Packs the assets directory into a single archive that ResourceManager maps at startup.
+// Usage: assetpack <assets dir> <output file> [--raw-rgba]
+// With --raw-rgba, images are decoded here and stored as RGBA8 so the game only
+// has to upload them.
+#include "core/AssetArchive.h"
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct PackedAsset
+    {
+        AssetArchiveEntry entry = {};
+        std::vector<char> blob;
+    };
+
+    bool isImage(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".png" || extension == ".jpg" || extension == ".bmp" || extension == ".tga";
+    }
+
+    uint64_t alignUp(uint64_t value)
+    {
+        return (value + AssetArchiveAlignment - 1) & ~static_cast<uint64_t>(AssetArchiveAlignment - 1);
+    }
+
+    bool packAsset(const std::filesystem::path& path, bool rawRgba, PackedAsset& asset)
+    {
+        std::string name = path.filename().string();
+        if (name.size() >= AssetArchiveNameLength)
+        {
+            std::cerr << "assetpack: name too long: " << name << std::endl;
+            return false;
+        }
+        std::memcpy(asset.entry.name, name.c_str(), name.size());
+
+        if (rawRgba && isImage(path))
+        {
+            sf::Image image;
+            if (!image.loadFromFile(path))
+            {
+                std::cerr << "assetpack: failed to decode " << path << std::endl;
+                return false;
+            }
+            const uint8_t* pPixels = image.getPixelsPtr();
+            asset.entry.encoding = ASSET_ENCODING_RGBA8;
+            asset.entry.width = image.getSize().x;
+            asset.entry.height = image.getSize().y;
+            asset.blob.assign(pPixels, pPixels + static_cast<size_t>(asset.entry.width) * asset.entry.height * 4);
+        }
+        else
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+            {
+                std::cerr << "assetpack: failed to read " << path << std::endl;
+                return false;
+            }
+            asset.entry.encoding = ASSET_ENCODING_FILE;
+            asset.blob.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        asset.entry.size = asset.blob.size();
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: assetpack <assets dir> <output file> [--raw-rgba]" << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path assetsDir = argv[1];
+    std::filesystem::path outputPath = argv[2];
+    bool rawRgba = argc > 3 && std::strcmp(argv[3], "--raw-rgba") == 0;
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& dirEntry : std::filesystem::directory_iterator(assetsDir))
+    {
+        // Skip hidden files such as .DS_Store
+        if (dirEntry.is_regular_file() && dirEntry.path().filename().string()[0] != '.')
+            files.push_back(dirEntry.path());
+    }
+    // The index is binary searched by name at load time
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.filename().string() < b.filename().string(); });
+
+    std::vector<PackedAsset> assets(files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (!packAsset(files[i], rawRgba, assets[i]))
+            return 1;
+    }
+
+    uint64_t offset = alignUp(sizeof(AssetArchiveHeader) + assets.size() * sizeof(AssetArchiveEntry));
+    for (PackedAsset& asset : assets)
+    {
+        asset.entry.offset = offset;
+        offset = alignUp(offset + asset.entry.size);
+    }
+
+    AssetArchiveHeader header = {};
+    std::memcpy(header.magic, AssetArchiveMagic, sizeof(AssetArchiveMagic));
+    header.version = AssetArchiveVersion;
+    header.entryCount = static_cast<uint32_t>(assets.size());
+
+    // Write next to the target and rename so a running game never maps a half-written file
+    std::filesystem::path tempPath = outputPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "assetpack: failed to open " << tempPath << std::endl;
+            return 1;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const PackedAsset& asset : assets)
+            file.write(reinterpret_cast<const char*>(&asset.entry), sizeof(asset.entry));
+
+        const char padding[AssetArchiveAlignment] = {};
+        for (const PackedAsset& asset : assets)
+        {
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(asset.entry.offset - position));
+            file.write(asset.blob.data(), static_cast<std::streamsize>(asset.blob.size()));
+        }
+        if (!file)
+        {
+            std::cerr << "assetpack: failed to write " << tempPath << std::endl;
+            return 1;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, outputPath, error);
+    if (error)
+    {
+        std::cerr << "assetpack: failed to replace " << outputPath << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    std::cout << "assetpack: packed " << assets.size() << " assets into " << outputPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Steps many particle worlds headless through ParticleWorldBatch, for balancing
+// runs and as its benchmark. Every world gets the game's sand/water stream and
+// wood blobs, seeded by its index. With --check the same worlds are stepped again
+// one after another on this thread, and both runs must end cell for cell the same.
+// Usage: batchsim [worlds] [steps] [--check]
+#include "Constants.h"
+#include "core/FrameArena.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+#include "particles/EmitterSystem.h"
+#include "particles/ParticleWorldBatch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr float StepDt = 1.0f / 60.0f;
+    constexpr float WoodSpawnInterval = 2.5f;
+
+    void addGameEmitters(EmitterSystem& emitters)
+    {
+        EmitterDesc stream;
+        stream.rate = StreamEmitterRate;
+        stream.shape = EMITTER_SHAPE_POINTS;
+        stream.areaMin = {WindowWidth - 50.0f, 10.0f};
+        stream.areaMax = {WindowWidth - 10.0f, 10.0f};
+        stream.schedule = {{MAT_ID_SAND, 2.0f, 4.0f}, {MAT_ID_WATER, 0.2f, 1.0f}};
+        stream.budgetPerFrame = 8;
+        emitters.addEmitter(stream);
+
+        float margin = 75.0f;
+        EmitterDesc wood;
+        wood.rate = 1.0f / WoodSpawnInterval;
+        wood.shape = EMITTER_SHAPE_BLOB;
+        wood.areaMin = {margin, margin};
+        wood.areaMax = {WindowWidth - margin, WindowHeight - margin};
+        wood.minRadius = 20.0f;
+        wood.maxRadius = 40.0f;
+        wood.density = WoodBlobDensity;
+        wood.schedule = {{MAT_ID_WOOD, 1.0f, 1.0f}};
+        emitters.addEmitter(wood);
+    }
+
+    std::vector<EmitterSystem> makeEmitters(size_t worldCount)
+    {
+        std::vector<EmitterSystem> emitters(worldCount);
+        for (size_t i = 0; i < worldCount; ++i)
+        {
+            emitters[i].setSeed(static_cast<uint32_t>(i) + 1);
+            addGameEmitters(emitters[i]);
+        }
+        return emitters;
+    }
+
+    double cellsPerSecond(size_t worldCount, uint32_t steps, double seconds)
+    {
+        return static_cast<double>(worldCount) * steps * GRID_WIDTH * GRID_HEIGHT / seconds;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t worldCount = 32;
+    uint32_t steps = 600;
+    bool check = false;
+    int position = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--check") == 0)
+            check = true;
+        else if (position++ == 0)
+            worldCount = std::strtoul(argv[i], nullptr, 10);
+        else
+            steps = static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (worldCount == 0 || steps == 0)
+    {
+        std::fprintf(stderr, "Usage: batchsim [worlds] [steps] [--check]\n");
+        return 1;
+    }
+
+    Log::init();
+    JobSystem::init();
+
+    std::vector<EmitterSystem> emitters = makeEmitters(worldCount);
+    ParticleWorldBatch batch(worldCount);
+    auto start = std::chrono::steady_clock::now();
+    batch.run(steps, StepDt, [&emitters](size_t index, ParticleWorld& world) { emitters[index].update(StepDt, world); });
+    double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("batch:  %zu worlds x %u steps on %u workers + caller: %.1f s, %.1f M cells/s\n",
+                worldCount, steps, JobSystem::getWorkerCount(), batchSeconds,
+                cellsPerSecond(worldCount, steps, batchSeconds) / 1e6);
+
+    int result = 0;
+    if (check)
+    {
+        // The same worlds, from the same seeds, one at a time
+        std::vector<EmitterSystem> serialEmitters = makeEmitters(worldCount);
+        ParticleWorldBatch serial(worldCount);
+        start = std::chrono::steady_clock::now();
+        for (uint32_t step = 0; step < steps; ++step)
+        {
+            for (size_t i = 0; i < worldCount; ++i)
+            {
+                serialEmitters[i].update(StepDt, serial.getWorld(i));
+                serial.getWorld(i).update(StepDt);
+                FrameArena::reset();
+            }
+        }
+        double serialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("serial: %.1f s, %.1f M cells/s, batch speedup %.2fx\n", serialSeconds,
+                    cellsPerSecond(worldCount, steps, serialSeconds) / 1e6, serialSeconds / batchSeconds);
+
+        size_t mismatchedWorlds = 0;
+        for (size_t i = 0; i < worldCount; ++i)
+        {
+            const ParticleWorld& a = batch.getWorld(i);
+            const ParticleWorld& b = serial.getWorld(i);
+            for (size_t cell = 0; cell < a.getCellCount(); ++cell)
+            {
+                if (a.getCells()[cell].getId() != b.getCells()[cell].getId())
+                {
+                    mismatchedWorlds++;
+                    break;
+                }
+            }
+        }
+        std::printf("check: %zu of %zu worlds differ from the serial run\n", mismatchedWorlds, worldCount);
+        result = mismatchedWorlds == 0 ? 0 : 1;
+    }
+
+    JobSystem::shutdown();
+    Log::shutdown();
+    return result;
+}